@@ -0,0 +1,98 @@
+#pragma once
+
+#include "config-validator.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <string>
+
+namespace phosphor
+{
+namespace led
+{
+namespace benchmark
+{
+
+/** @brief Shape of a generated LED group configuration */
+struct ConfigShape
+{
+    /** @brief Number of groups */
+    size_t groups = 100;
+
+    /** @brief Number of LEDs */
+    size_t leds = 50;
+
+    /** @brief Number of LEDs of each group */
+    size_t fanOut = 4;
+
+    /** @brief Rule of the configuration */
+    PriorityMode mode = PriorityMode::led;
+};
+
+/** @brief Get the number of LEDs giving each LED a fan-in
+ *
+ *  @param[in] groups - Number of groups
+ *  @param[in] fanOut - Number of LEDs of each group
+ *  @param[in] fanIn  - Number of groups of each LED
+ *
+ *  @return The number of LEDs
+ */
+inline size_t getLedCount(size_t groups, size_t fanOut, size_t fanIn)
+{
+    auto leds = ((groups * fanOut) + fanIn - 1) / std::max<size_t>(fanIn, 1);
+    return std::max(leds, fanOut);
+}
+
+/** @brief Generate a configuration which passes validateConfigV1
+ *  @details The LEDs are dealt to the groups in turn, so every LED is in the
+ *  same number of groups and the LEDs of a group are distinct. With the group
+ *  priority rule every group has its own priority, with the LED priority rule
+ *  every LED has the same priority action in all its groups.
+ *
+ *  @param[in] shape - Shape of the configuration
+ *
+ *  @return The JSON configuration (version 1)
+ */
+inline nlohmann::json generateConfig(const ConfigShape& shape)
+{
+    static constexpr const char* actions[] = {"On", "Blink", "Off"};
+
+    auto fanOut = std::min(shape.fanOut, shape.leds);
+    auto groups = nlohmann::json::array();
+    for (size_t group = 0; group < shape.groups; ++group)
+    {
+        auto members = nlohmann::json::array();
+        for (size_t i = 0; i < fanOut; ++i)
+        {
+            auto led = ((group * fanOut) + i) % shape.leds;
+            nlohmann::json member = {{"Name", "led" + std::to_string(led)},
+                                     {"DutyOn", 50}};
+            if (shape.mode == PriorityMode::group)
+            {
+                member["Action"] = actions[(group + i) % 3];
+            }
+            else
+            {
+                member["Action"] = actions[(group + i) % 2];
+                member["Priority"] = actions[led % 2];
+            }
+            member["Period"] = member["Action"] == "Blink" ? 1000 : 0;
+            members.push_back(std::move(member));
+        }
+
+        nlohmann::json entry = {{"group", "group" + std::to_string(group)},
+                                {"members", std::move(members)}};
+        if (shape.mode == PriorityMode::group)
+        {
+            entry["Priority"] = group + 1;
+        }
+        groups.push_back(std::move(entry));
+    }
+
+    return {{"version", 1}, {"leds", std::move(groups)}};
+}
+
+} // namespace benchmark
+} // namespace led
+} // namespace phosphor
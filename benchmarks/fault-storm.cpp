@@ -0,0 +1,533 @@
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <CLI/CLI.hpp>
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/server/manager.hpp>
+#include <sdbusplus/server/object.hpp>
+#include <sdbusplus/vtable.hpp>
+#include <sdeventplus/event.hpp>
+#include <xyz/openbmc_project/Association/Definitions/server.hpp>
+#include <xyz/openbmc_project/Association/server.hpp>
+#include <xyz/openbmc_project/Led/Group/server.hpp>
+#include <xyz/openbmc_project/State/Decorator/OperationalStatus/server.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using AssociationInherit = sdbusplus::server::object_t<
+    sdbusplus::xyz::openbmc_project::Association::server::Definitions>;
+using InventoryInherit = sdbusplus::server::object_t<
+    sdbusplus::xyz::openbmc_project::State::Decorator::server::
+        OperationalStatus,
+    sdbusplus::xyz::openbmc_project::Association::server::Definitions>;
+using EndpointsInherit = sdbusplus::server::object_t<
+    sdbusplus::xyz::openbmc_project::server::Association>;
+using GroupInherit = sdbusplus::server::object_t<
+    sdbusplus::xyz::openbmc_project::Led::server::Group>;
+
+static constexpr auto mapperService = "xyz.openbmc_project.ObjectMapper";
+static constexpr auto mapperPath = "/xyz/openbmc_project/object_mapper";
+static constexpr auto mapperIntf = "xyz.openbmc_project.ObjectMapper";
+static constexpr auto ledService = "xyz.openbmc_project.LED.GroupManager";
+static constexpr auto ledGroupsRoot = "/xyz/openbmc_project/led/groups";
+static constexpr auto inventoryService = "xyz.openbmc_project.Inventory.Manager";
+static constexpr auto inventoryRoot = "/xyz/openbmc_project/inventory";
+static constexpr auto loggingService = "xyz.openbmc_project.Logging";
+static constexpr auto loggingRoot = "/xyz/openbmc_project/logging";
+
+/** @brief Get the inventory path of a FRU */
+static std::string getFruPath(size_t index)
+{
+    return std::string(inventoryRoot) + "/system/fru" + std::to_string(index);
+}
+
+/** @brief Get the fault LED group path of a FRU, as the monitors name it */
+static std::string getGroupPath(size_t index)
+{
+    return std::string(ledGroupsRoot) + "/fru" + std::to_string(index) +
+           "_fault";
+}
+
+/** @class Recorder
+ *  @brief Records the writes of the LED groups expected during a phase
+ */
+class Recorder
+{
+  public:
+    /** @brief Expect a write of a group, the event is raised now */
+    void expect(const std::string& group, bool assert)
+    {
+        expected[group] = {assert, Clock::now()};
+    }
+
+    /** @brief Record a write of a group */
+    void recorded(const std::string& group, bool assert)
+    {
+        auto now = Clock::now();
+        ++writes;
+        auto it = expected.find(group);
+        if (it == expected.end() || it->second.first != assert)
+        {
+            return;
+        }
+
+        latencies.emplace_back(now - it->second.second);
+        last = now;
+        expected.erase(it);
+    }
+
+    /** @brief Whether all the expected writes were recorded */
+    bool done() const
+    {
+        return expected.empty();
+    }
+
+    /** @brief Start a phase */
+    void start()
+    {
+        expected.clear();
+        first = Clock::now();
+        last = first;
+    }
+
+    /** @brief Number of writes of the LED groups, expected or not */
+    size_t writes = 0;
+
+    /** @brief Latencies of the expected writes recorded */
+    std::vector<Clock::duration> latencies;
+
+    /** @brief Start of the current phase */
+    Clock::time_point first{};
+
+    /** @brief Last expected write recorded */
+    Clock::time_point last{};
+
+  private:
+    /** @brief Expected state and event time of the groups */
+    std::unordered_map<std::string, std::pair<bool, Clock::time_point>>
+        expected;
+};
+
+/** @class FakeGroup
+ *  @brief LED group recording the writes of its Asserted property
+ */
+class FakeGroup : public GroupInherit
+{
+  public:
+    FakeGroup(sdbusplus::bus_t& bus, const std::string& path,
+              Recorder& recorder) :
+        GroupInherit(bus, path.c_str()), path(path), recorder(recorder)
+    {}
+
+    bool asserted(bool value) override
+    {
+        recorder.recorded(path, value);
+        return GroupInherit::asserted(value);
+    }
+
+  private:
+    std::string path;
+    Recorder& recorder;
+};
+
+/** @class FakeMapper
+ *  @brief The mapper methods used by the fault monitors, and the fault LED
+ *         association objects of the FRUs
+ */
+class FakeMapper
+{
+  public:
+    FakeMapper(sdbusplus::bus_t& bus, std::vector<std::string> groups,
+               size_t frus) :
+        groups(std::move(groups)),
+        intf(bus, mapperPath, mapperIntf, vtable, this)
+    {
+        for (size_t i = 0; i < frus; ++i)
+        {
+            associations.emplace_back(getFruPath(i) + "/fault_identifying");
+            auto object = std::make_unique<EndpointsInherit>(
+                bus, associations.back().c_str(),
+                EndpointsInherit::action::defer_emit);
+            object->endpoints({getGroupPath(i)}, true);
+            object->emit_object_added();
+            endpoints.emplace_back(std::move(object));
+        }
+    }
+
+  private:
+    /** @brief GetObject, the service is found by the path prefix */
+    static int getObject(sd_bus_message* m, void*, sd_bus_error* error)
+    {
+        sdbusplus::message_t msg(m);
+        std::string path;
+        std::vector<std::string> interfaces;
+        msg.read(path, interfaces);
+
+        const char* service = nullptr;
+        if (path.starts_with(ledGroupsRoot))
+        {
+            service = ledService;
+        }
+        else if (path.starts_with(loggingRoot))
+        {
+            service = loggingService;
+        }
+        else if (path.starts_with(inventoryRoot))
+        {
+            service = inventoryService;
+        }
+        else
+        {
+            return sd_bus_error_set(
+                error, "xyz.openbmc_project.Common.Error.ResourceNotFound",
+                path.c_str());
+        }
+
+        auto reply = msg.new_method_return();
+        reply.append(std::map<std::string, std::vector<std::string>>{
+            {service, interfaces}});
+        reply.method_return();
+        return 1;
+    }
+
+    /** @brief GetSubTreePaths, only the LED groups and the fault LED
+     *         association objects are known */
+    static int getSubTreePaths(sd_bus_message* m, void* context,
+                               sd_bus_error*)
+    {
+        auto* mapper = static_cast<FakeMapper*>(context);
+        sdbusplus::message_t msg(m);
+        std::string path;
+        int32_t depth = 0;
+        std::vector<std::string> interfaces;
+        msg.read(path, depth, interfaces);
+
+        auto reply = msg.new_method_return();
+        if (path.starts_with(ledGroupsRoot))
+        {
+            reply.append(mapper->groups);
+        }
+        else if (path.starts_with(inventoryRoot))
+        {
+            reply.append(mapper->associations);
+        }
+        else
+        {
+            reply.append(std::vector<std::string>{});
+        }
+        reply.method_return();
+        return 1;
+    }
+
+    static constexpr sdbusplus::vtable_t vtable[] = {
+        sdbusplus::vtable::start(),
+        sdbusplus::vtable::method("GetObject", "sas", "a{sas}", getObject),
+        sdbusplus::vtable::method("GetSubTreePaths", "sias", "as",
+                                  getSubTreePaths),
+        sdbusplus::vtable::end()};
+
+    std::vector<std::string> groups;
+    std::vector<std::string> associations;
+    std::vector<std::unique_ptr<EndpointsInherit>> endpoints;
+    sdbusplus::server::interface_t intf;
+};
+
+/** @brief Modes of the fault monitors */
+enum class Mode
+{
+    fru,
+    operationalStatus,
+};
+
+/** @class Storm
+ *  @brief Raises and clears the faults of the FRUs
+ */
+class Storm
+{
+  public:
+    Storm(sdbusplus::bus_t& bus, Mode mode, size_t frus, Recorder& recorder) :
+        bus(bus), mode(mode), frus(frus), recorder(recorder)
+    {
+        for (size_t i = 0; i < frus; ++i)
+        {
+            auto fru = getFruPath(i);
+            auto inventory = std::make_unique<InventoryInherit>(
+                bus, fru.c_str(), InventoryInherit::action::defer_emit);
+            inventory->functional(true, true);
+            inventory->associations(
+                {{"fault_identifying", "fault_inventory_object",
+                  getGroupPath(i)}},
+                true);
+            inventory->emit_object_added();
+            inventories.emplace_back(std::move(inventory));
+        }
+    }
+
+    /** @brief Raise the fault of a FRU */
+    void raise(size_t index)
+    {
+        recorder.expect(getGroupPath(index), true);
+        if (mode == Mode::operationalStatus)
+        {
+            inventories[index]->functional(false);
+            return;
+        }
+
+        auto path = std::string(loggingRoot) + "/entry/" +
+                    std::to_string(++lastEntry);
+        auto entry = std::make_unique<AssociationInherit>(
+            bus, path.c_str(), AssociationInherit::action::defer_emit);
+        entry->associations(
+            {{"callout", "fault", getFruPath(index)}}, true);
+        entry->emit_object_added();
+        entries[index] = std::move(entry);
+    }
+
+    /** @brief Clear the fault of a FRU */
+    void clear(size_t index)
+    {
+        recorder.expect(getGroupPath(index), false);
+        if (mode == Mode::operationalStatus)
+        {
+            inventories[index]->functional(true);
+            return;
+        }
+
+        // Deleting the entry emits InterfacesRemoved
+        entries.erase(index);
+    }
+
+    /** @brief Number of FRUs */
+    size_t size() const
+    {
+        return frus;
+    }
+
+  private:
+    sdbusplus::bus_t& bus;
+    Mode mode;
+    size_t frus;
+    Recorder& recorder;
+    std::vector<std::unique_ptr<InventoryInherit>> inventories;
+    std::unordered_map<size_t, std::unique_ptr<AssociationInherit>> entries;
+    size_t lastEntry = 0;
+};
+
+/** @brief Run the event loop until the expected writes are recorded
+ *
+ *  @return false on timeout
+ */
+static bool waitDone(sdeventplus::Event& event, Recorder& recorder,
+                     std::chrono::seconds timeout)
+{
+    auto deadline = Clock::now() + timeout;
+    while (!recorder.done())
+    {
+        if (Clock::now() >= deadline)
+        {
+            return false;
+        }
+        event.run(std::chrono::milliseconds(100));
+    }
+    return true;
+}
+
+/** @brief Print the statistics of a phase */
+static void report(const char* phase, Recorder& recorder, size_t events)
+{
+    auto& latencies = recorder.latencies;
+    std::ranges::sort(latencies);
+    auto ms = [](Clock::duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    };
+    auto percentile = [&latencies, &ms](double p) {
+        if (latencies.empty())
+        {
+            return 0.0;
+        }
+        auto i = static_cast<size_t>(p * static_cast<double>(latencies.size() -
+                                                             1));
+        return ms(latencies[i]);
+    };
+
+    double seconds =
+        std::chrono::duration<double>(recorder.last - recorder.first).count();
+    std::printf("%-9s events=%zu events/s=%.0f p50=%.2fms p90=%.2fms "
+                "p99=%.2fms max=%.2fms\n",
+                phase, events,
+                seconds > 0 ? static_cast<double>(events) / seconds : 0.0,
+                percentile(0.50), percentile(0.90), percentile(0.99),
+                percentile(1.0));
+    latencies.clear();
+}
+
+/** @brief Print the memory of the monitor */
+static void reportMemory(pid_t pid)
+{
+    std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.starts_with("VmRSS:") || line.starts_with("VmHWM:"))
+        {
+            std::printf("monitor   %s\n", line.c_str());
+        }
+    }
+}
+
+/** @brief Start the monitor */
+static pid_t spawn(const std::vector<std::string>& command)
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        std::vector<char*> argv;
+        for (const auto& arg : command)
+        {
+            argv.emplace_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.emplace_back(nullptr);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    return pid;
+}
+
+/** @brief Fault storm benchmark of the fault monitors
+ *
+ *  Hosts stand-ins of the services the fault monitors talk to: the mapper, a
+ *  logging service creating and deleting entries with callout associations,
+ *  an inventory manager flipping the OperationalStatus of the FRUs and an LED
+ *  group manager recording the writes of the Asserted property. The monitor
+ *  given on the command line is started, storms of faults are raised then
+ *  cleared, and the throughput, the latency from the event to the LED group
+ *  write and the memory of the monitor are reported.
+ */
+int main(int argc, char** argv)
+{
+    CLI::App app("Fault storm benchmark of the fault monitors");
+
+    Mode mode = Mode::fru;
+    app.add_option("--mode", mode, "Mode of the monitor")
+        ->transform(CLI::CheckedTransformer(
+            std::map<std::string, Mode>{
+                {"fru", Mode::fru},
+                {"operational-status", Mode::operationalStatus}},
+            CLI::ignore_case));
+
+    size_t frus = 1000;
+    app.add_option("--frus", frus, "Number of FRUs faulted at once");
+
+    size_t rounds = 3;
+    app.add_option("--rounds", rounds, "Number of storms");
+
+    unsigned timeout = 60;
+    app.add_option("--timeout", timeout, "Timeout of a phase in seconds");
+
+    std::vector<std::string> command;
+    app.add_option("command", command, "The monitor and its arguments")
+        ->required();
+
+    CLI11_PARSE(app, argc, argv);
+
+    auto event = sdeventplus::Event::get_default();
+    auto bus = sdbusplus::bus::new_default();
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+
+    sdbusplus::server::manager_t groupsManager(bus, ledGroupsRoot);
+    sdbusplus::server::manager_t inventoryManager(bus, inventoryRoot);
+    sdbusplus::server::manager_t loggingManager(bus, loggingRoot);
+
+    Recorder recorder;
+    std::vector<std::string> groupPaths;
+    std::vector<std::unique_ptr<FakeGroup>> groups;
+    for (size_t i = 0; i < frus; ++i)
+    {
+        groupPaths.emplace_back(getGroupPath(i));
+        groups.emplace_back(
+            std::make_unique<FakeGroup>(bus, groupPaths.back(), recorder));
+    }
+    FakeMapper mapper(bus, groupPaths, frus);
+    Storm storm(bus, mode, frus, recorder);
+
+    bus.request_name(mapperService);
+    bus.request_name(ledService);
+    bus.request_name(inventoryService);
+    bus.request_name(loggingService);
+
+    auto pid = spawn(command);
+    if (pid < 0)
+    {
+        std::fprintf(stderr, "Failed to start the monitor\n");
+        return 1;
+    }
+
+    // The fault of the first FRU is seen once the monitor is up, by its
+    // signal matches or by its startup scan.
+    int rc = 0;
+    auto phaseTimeout = std::chrono::seconds(timeout);
+    recorder.start();
+    storm.raise(0);
+    if (!waitDone(event, recorder, phaseTimeout))
+    {
+        std::fprintf(stderr, "The monitor did not start\n");
+        rc = 1;
+    }
+    recorder.start();
+    storm.clear(0);
+    if (rc == 0 && !waitDone(event, recorder, phaseTimeout))
+    {
+        std::fprintf(stderr, "The monitor did not clear the fault\n");
+        rc = 1;
+    }
+    recorder.latencies.clear();
+
+    std::printf("mode=%s frus=%zu rounds=%zu\n",
+                mode == Mode::fru ? "fru" : "operational-status", frus,
+                rounds);
+    for (size_t round = 0; rc == 0 && round < rounds; ++round)
+    {
+        recorder.start();
+        for (size_t i = 0; i < storm.size(); ++i)
+        {
+            storm.raise(i);
+        }
+        if (!waitDone(event, recorder, phaseTimeout))
+        {
+            std::fprintf(stderr, "Timeout raising the faults\n");
+            rc = 1;
+        }
+        report("raise", recorder, storm.size());
+
+        recorder.start();
+        for (size_t i = 0; rc == 0 && i < storm.size(); ++i)
+        {
+            storm.clear(i);
+        }
+        if (rc == 0 && !waitDone(event, recorder, phaseTimeout))
+        {
+            std::fprintf(stderr, "Timeout clearing the faults\n");
+            rc = 1;
+        }
+        report("clear", recorder, storm.size());
+    }
+
+    std::printf("writes    %zu\n", recorder.writes);
+    reportMemory(pid);
+
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    return rc;
+}
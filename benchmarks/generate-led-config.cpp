@@ -0,0 +1,79 @@
+#include "config-generator.hpp"
+#include "config-validator.hpp"
+#include "json-parser.hpp"
+
+#include <CLI/CLI.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+
+using namespace phosphor::led;
+
+int main(int argc, char** argv)
+{
+    CLI::App app("Generate an LED group configuration of a given size");
+
+    benchmark::ConfigShape shape;
+    app.add_option("--groups", shape.groups, "Number of groups");
+    auto* leds = app.add_option("--leds", shape.leds, "Number of LEDs");
+    app.add_option("--fan-out", shape.fanOut, "Number of LEDs of each group");
+
+    size_t fanIn = 0;
+    app.add_option("--fan-in", fanIn,
+                   "Number of groups of each LED, sets the number of LEDs")
+        ->excludes(leds);
+
+    app.add_option("--mode", shape.mode, "Priority rule of the groups")
+        ->transform(CLI::CheckedTransformer(
+            std::map<std::string, PriorityMode>{{"led", PriorityMode::led},
+                                                {"group", PriorityMode::group}},
+            CLI::ignore_case));
+
+    std::string output;
+    app.add_option("-o,--output", output,
+                   "Path of the configuration, printed when not set");
+
+    CLI11_PARSE(app, argc, argv);
+
+    if (fanIn != 0)
+    {
+        shape.leds = benchmark::getLedCount(shape.groups, shape.fanOut, fanIn);
+    }
+    if (shape.groups == 0 || shape.leds == 0)
+    {
+        std::cerr << "The configuration needs groups and LEDs\n";
+        return 1;
+    }
+
+    auto json = benchmark::generateConfig(shape);
+
+    // Load the configuration as the manager does, it must be valid
+    try
+    {
+        validateConfigV1(loadJsonConfigV1(json));
+    }
+    catch (const ConfigValidationException& e)
+    {
+        // The exception logged the details
+        std::cerr << "The generated configuration is not valid, reason "
+                  << static_cast<int>(e.reason) << "\n";
+        return 1;
+    }
+
+    if (output.empty())
+    {
+        std::cout << json.dump(4) << "\n";
+        return 0;
+    }
+
+    std::ofstream file(output);
+    file << json.dump(4) << "\n";
+    if (!file)
+    {
+        std::cerr << "Failed to write " << output << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include "config-generator.hpp"
+#include "config-validator.hpp"
+#include "json-parser.hpp"
+#include "manager.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <CLI/CLI.hpp>
+#include <sdbusplus/bus.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace phosphor::led;
+using Clock = std::chrono::steady_clock;
+
+/** @brief Get the milliseconds elapsed since a time */
+static double getElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+}
+
+/** @brief Get a size field of /proc/self/status in kB */
+static size_t getStatusKb(const std::string& field)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.starts_with(field))
+        {
+            return std::stoul(line.substr(field.size()));
+        }
+    }
+    return 0;
+}
+
+/** @brief Measure one configuration size and print its row
+ *
+ *  @param[in] shape   - Shape of the configuration
+ *  @param[in] toggles - Number of toggles of a group
+ *  @param[in] dir     - Directory of the generated configuration
+ */
+static void measure(const benchmark::ConfigShape& shape, size_t toggles,
+                    const std::filesystem::path& dir)
+{
+    auto path = dir / ("led-config-" + std::to_string(shape.groups) + ".json");
+    {
+        std::ofstream file(path);
+        file << benchmark::generateConfig(shape).dump();
+    }
+    auto baseRss = getStatusKb("VmRSS:");
+
+    auto start = Clock::now();
+    auto ledMap = loadJsonConfig(path);
+    auto loadMs = getElapsedMs(start);
+    std::filesystem::remove(path);
+
+    start = Clock::now();
+    validateConfigV1(ledMap);
+    auto validateMs = getElapsedMs(start);
+
+    auto bus = sdbusplus::bus::new_default();
+    start = Clock::now();
+    Manager manager(bus, ledMap);
+    auto indexMs = getElapsedMs(start);
+
+    std::vector<GroupHandle> handles;
+    for (const auto& [groupPath, group] : ledMap)
+    {
+        handles.push_back(*manager.findGroupHandle(groupPath));
+    }
+
+    // Toggle groups spread over the configuration, nothing else asserted
+    ActionSet ledsAssert{};
+    ActionSet ledsDeAssert{};
+    start = Clock::now();
+    for (size_t i = 0; i < toggles; ++i)
+    {
+        auto handle = handles[(i * 7919) % handles.size()];
+        manager.setGroupState(handle, true, ledsAssert, ledsDeAssert);
+        manager.setGroupState(handle, false, ledsAssert, ledsDeAssert);
+        ledsAssert.clear();
+        ledsDeAssert.clear();
+    }
+    auto toggleUs = getElapsedMs(start) * 1000 / (2 * toggles);
+
+    // Assert every group, as a restore of the asserted groups does
+    start = Clock::now();
+    for (auto handle : handles)
+    {
+        manager.setGroupState(handle, true, ledsAssert, ledsDeAssert);
+    }
+    auto bulkMs = getElapsedMs(start);
+
+    // Toggle again with every other group asserted
+    start = Clock::now();
+    for (size_t i = 0; i < toggles; ++i)
+    {
+        auto handle = handles[(i * 7919) % handles.size()];
+        manager.setGroupState(handle, false, ledsAssert, ledsDeAssert);
+        manager.setGroupState(handle, true, ledsAssert, ledsDeAssert);
+        ledsAssert.clear();
+        ledsDeAssert.clear();
+    }
+    auto loadedToggleUs = getElapsedMs(start) * 1000 / (2 * toggles);
+
+    std::printf("%zu,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%zu\n",
+                shape.groups, shape.leds, shape.fanOut, loadMs, validateMs,
+                indexMs, toggleUs, loadedToggleUs, bulkMs,
+                getStatusKb("VmRSS:") - baseRss);
+}
+
+int main(int argc, char** argv)
+{
+    CLI::App app("Scaling benchmark of the LED group manager");
+
+    benchmark::ConfigShape shape;
+    app.add_option("--mode", shape.mode, "Priority rule of the groups")
+        ->transform(CLI::CheckedTransformer(
+            std::map<std::string, PriorityMode>{{"led", PriorityMode::led},
+                                                {"group", PriorityMode::group}},
+            CLI::ignore_case));
+    app.add_option("--fan-out", shape.fanOut, "Number of LEDs of each group");
+
+    size_t fanIn = 8;
+    app.add_option("--fan-in", fanIn, "Number of groups of each LED");
+
+    std::vector<size_t> sizes{100, 1000, 10000, 100000};
+    app.add_option("--groups", sizes, "Numbers of groups measured");
+
+    size_t toggles = 10000;
+    app.add_option("--toggles", toggles, "Number of toggles measured");
+
+    std::string dir = std::filesystem::temp_directory_path();
+    app.add_option("--dir", dir, "Directory of the generated configurations");
+
+    CLI11_PARSE(app, argc, argv);
+
+    if (toggles == 0 || fanIn == 0)
+    {
+        std::fprintf(stderr, "The toggles and the fan-in cannot be 0\n");
+        return 1;
+    }
+
+    std::printf("groups,leds,fan_out,load_ms,validate_ms,index_ms,toggle_us,"
+                "loaded_toggle_us,bulk_assert_ms,rss_kb\n");
+    for (auto groups : sizes)
+    {
+        if (groups == 0)
+        {
+            continue;
+        }
+        shape.groups = groups;
+        shape.leds = benchmark::getLedCount(groups, shape.fanOut, fanIn);
+
+        // Measure each size in its own process, so the memory of a size is
+        // not reused by the next one
+        std::fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            measure(shape, toggles, dir);
+            std::fflush(stdout);
+            _exit(0);
+        }
+
+        int status = 0;
+        if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != 0)
+        {
+            std::fprintf(stderr, "Failed to measure %zu groups\n", groups);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# This shell script runs the fault storm benchmark of the fault monitors on
+# a private dbus-daemon, so the benchmark does not touch the system bus.
+# The monitor is built for one mode, pass a monitor per mode to compare them.
+
+function usage()
+{
+    echo "run-fault-storm.sh <fault-storm> [fru|operational-status] <monitor> [fault-storm options]"
+    echo "Example: run-fault-storm.sh build/benchmarks/fault-storm fru build/fault-monitor/phosphor-fru-fault-monitor"
+    echo "Example: run-fault-storm.sh build/benchmarks/fault-storm operational-status build/fault-monitor/phosphor-fru-fault-monitor --frus 5000"
+    return 0;
+}
+
+# We need at least 3 arguments
+if [ $# -lt 3 ]; then
+    echo "At least THREE arguments needed";
+    usage;
+    exit 1;
+fi
+
+storm=$1
+mode=$2
+monitor=$3
+shift 3
+
+if [ "$mode" != "fru" ] && [ "$mode" != "operational-status" ]; then
+    echo "Bad mode $mode passed";
+    usage;
+    exit 1;
+fi
+
+dir=$(mktemp -d)
+trap 'kill $daemon 2>/dev/null; rm -rf "$dir"' EXIT
+
+dbus-daemon --session --nofork --nopidfile --address="unix:path=$dir/bus" &
+daemon=$!
+
+# Wait for the bus socket
+for _ in $(seq 50); do
+    [ -S "$dir/bus" ] && break
+    sleep 0.1
+done
+
+# The monitors and the stand-ins connect to the default bus, point it to
+# the private bus.
+export DBUS_STARTER_BUS_TYPE=system
+export DBUS_SYSTEM_BUS_ADDRESS="unix:path=$dir/bus"
+export DBUS_SESSION_BUS_ADDRESS="unix:path=$dir/bus"
+
+# The dampening holds the LED groups, disable it to measure the throughput.
+"$storm" --mode "$mode" "$@" -- "$monitor" --min-hold-ms 0 --max-transitions 0
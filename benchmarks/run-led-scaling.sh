@@ -0,0 +1,60 @@
+#!/bin/bash
+
+# This shell script runs the scaling benchmark of the LED group manager and
+# plots the costs against the number of groups when gnuplot is installed.
+
+function usage()
+{
+    echo "run-led-scaling.sh <led-scaling> <output directory> [led-scaling options]"
+    echo "Example: run-led-scaling.sh build/benchmarks/led-scaling scaling"
+    echo "Example: run-led-scaling.sh build/benchmarks/led-scaling scaling --mode group --groups 100 1000 10000"
+    return 0;
+}
+
+# We need at least 2 arguments
+if [ $# -lt 2 ]; then
+    echo "At least TWO arguments needed";
+    usage;
+    exit 1;
+fi
+
+scaling=$1
+output=$2
+shift 2
+
+mkdir -p "$output"
+csv="$output/led-scaling.csv"
+
+"$scaling" "$@" > "$csv" || exit 1
+cat "$csv"
+
+if ! command -v gnuplot > /dev/null; then
+    echo "gnuplot is not installed, the results are in $csv"
+    exit 0
+fi
+
+gnuplot <<EOF
+set datafile separator ","
+set key autotitle columnhead left top
+set logscale xy
+set xlabel "groups"
+set grid
+
+set terminal png size 1024,768
+set output "$output/led-scaling-time.png"
+set ylabel "ms"
+plot "$csv" using 1:4 with linespoints, \
+     "$csv" using 1:5 with linespoints, \
+     "$csv" using 1:6 with linespoints, \
+     "$csv" using 1:9 with linespoints
+
+set output "$output/led-scaling-toggle.png"
+set ylabel "us"
+plot "$csv" using 1:7 with linespoints, \
+     "$csv" using 1:8 with linespoints
+
+set output "$output/led-scaling-rss.png"
+set ylabel "kB"
+plot "$csv" using 1:10 with linespoints
+EOF
+echo "The plots are in $output"
@@ -1,19 +1,24 @@
 #include "fru-fault-monitor.hpp"
 
+#include "message-walker.hpp"
+
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/exception.hpp>
 #include <xyz/openbmc_project/Association/Definitions/common.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
-#include <xyz/openbmc_project/Led/Group/common.hpp>
-#include <xyz/openbmc_project/Logging/Entry/common.hpp>
 #include <xyz/openbmc_project/ObjectMapper/common.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+#include <tuple>
+#include <variant>
+
 using ObjectMapper = sdbusplus::common::xyz::openbmc_project::ObjectMapper;
 using AssociationDefinitions =
     sdbusplus::common::xyz::openbmc_project::association::Definitions;
-using LoggingEntry = sdbusplus::common::xyz::openbmc_project::logging::Entry;
 
 namespace phosphor
 {
@@ -30,238 +35,388 @@ using namespace phosphor::logging;
 
 static constexpr auto objMgrIntf = "org.freedesktop.DBus.ObjectManager";
 static constexpr auto ledGroups = "/xyz/openbmc_project/led/groups/";
+static constexpr auto loggingPath = "/xyz/openbmc_project/logging";
 
+using Path = std::string;
+using CalloutMap = std::unordered_map<Path, std::vector<Path>>;
 using AssociationList =
     std::vector<std::tuple<std::string, std::string, std::string>>;
-using Attributes = std::variant<bool, AssociationList>;
-using PropertyName = std::string;
-using PropertyMap = std::unordered_map<PropertyName, Attributes>;
-using InterfaceName = std::string;
-using InterfaceMap = std::unordered_map<InterfaceName, PropertyMap>;
-
-using Service = std::string;
-using Path = std::string;
-using Interface = std::string;
-using Interfaces = std::vector<Interface>;
-using MapperResponseType =
-    std::unordered_map<Path, std::unordered_map<Service, Interfaces>>;
 
-using ResourceNotFoundErr =
-    sdbusplus::xyz::openbmc_project::Common::Error::ResourceNotFound;
 using InvalidArgumentErr =
     sdbusplus::xyz::openbmc_project::Common::Error::InvalidArgument;
 
-using LedGroup = sdbusplus::common::xyz::openbmc_project::led::Group;
+/** @brief Get the fault LED group of a FRU
+ *
+ *  @param[in] path - Inventory path of the FRU
+ *
+ *  @return The LED group path, empty when the FRU path is invalid
+ */
+static std::string getFaultGroupPath(const std::string& path)
+{
+    auto pos = path.rfind('/');
+    if (pos == std::string::npos)
+    {
+        using namespace xyz::openbmc_project::Common;
+        report<InvalidArgumentErr>(
+            InvalidArgument::ARGUMENT_NAME("path"),
+            InvalidArgument::ARGUMENT_VALUE(path.c_str()));
+        return {};
+    }
+    auto unit = path.substr(pos + 1);
+
+    return ledGroups + unit + '_' + LED_FAULT;
+}
+
+/** @brief Read the callout FRUs of the interfaces of a log entry
+ *
+ *  The message is positioned at the "a{sa{sv}}" interfaces array, only the
+ *  Associations property is decoded.
+ *
+ *  @param[in] m     - The message
+ *  @param[out] frus - The callout FRUs
+ */
+static void readEntryCallouts(sd_bus_message* m, std::vector<std::string>& frus)
+{
+    walker::walkInterfaces(
+        m,
+        [](std::string_view intf) {
+            return intf == AssociationDefinitions::interface;
+        },
+        [&frus](std::string_view, std::string_view property,
+                sd_bus_message* msg) {
+            if (property !=
+                AssociationDefinitions::property_names::associations)
+            {
+                return false;
+            }
 
-std::string getService(sdbusplus::bus_t& bus, const std::string& path)
+            walker::checkSdBus(
+                sd_bus_message_enter_container(msg, SD_BUS_TYPE_VARIANT,
+                                               "a(sss)"),
+                "enter associations value");
+            walker::walkAssociations(
+                msg, [&frus](std::string_view, std::string_view reverse,
+                             std::string_view endpoint) {
+                    if (reverse == CALLOUT_REV_ASSOCIATION)
+                    {
+                        frus.emplace_back(endpoint);
+                    }
+                });
+            walker::checkSdBus(sd_bus_message_exit_container(msg),
+                               "exit associations value");
+            return true;
+        });
+}
+
+/** @brief Read the callouts of the entries of a GetManagedObjects reply
+ *
+ *  @param[in] reply - The GetManagedObjects reply of the logging service
+ *
+ *  @return The callout FRUs of each entry with callouts
+ */
+static CalloutMap readManagedCallouts(sdbusplus::message_t& reply)
 {
-    auto mapper = bus.new_method_call(
-        ObjectMapper::default_service, ObjectMapper::instance_path,
-        ObjectMapper::interface, ObjectMapper::method_names::get_object);
-    mapper.append(path.c_str(), std::vector<std::string>({objMgrIntf}));
+    CalloutMap callouts;
 
-    std::unordered_map<std::string, std::vector<std::string>> mapperResponse;
-    try
+    walker::walkManagedObjects(
+        reply.get(), [&callouts](std::string_view path, sd_bus_message* msg) {
+            if (path.find(ELOG_ENTRY) == std::string_view::npos)
+            {
+                // Not an error entry
+                return false;
+            }
+
+            std::vector<std::string> frus;
+            readEntryCallouts(msg, frus);
+            if (!frus.empty())
+            {
+                callouts.emplace(path, std::move(frus));
+            }
+            return true;
+        });
+
+    return callouts;
+}
+
+void Add::action(const std::string& path, bool assert)
+{
+    std::string ledPath = getFaultGroupPath(path);
+    if (ledPath.empty())
     {
-        auto mapperResponseMsg = bus.call(mapper);
-        mapperResponseMsg.read(mapperResponse);
+        return;
     }
-    catch (const sdbusplus::exception_t& e)
+
+    updater.set(ledPath, assert);
+}
+
+void Add::apply(const Callouts::Changes& changes)
+{
+    for (const auto& fru : changes.cleared)
     {
-        lg2::error(
-            "Failed to parse getService mapper response, ERROR = {ERROR}",
-            "ERROR", e);
-        using namespace xyz::openbmc_project::Common;
-        elog<ResourceNotFoundErr>(ResourceNotFound::RESOURCE(path.c_str()));
+        action(fru, false);
     }
-    if (mapperResponse.empty())
+    for (const auto& fru : changes.faulted)
     {
-        using namespace xyz::openbmc_project::Common;
-        elog<ResourceNotFoundErr>(ResourceNotFound::RESOURCE(path.c_str()));
-        return {};
+        action(fru, true);
     }
-
-    return mapperResponse.cbegin()->first;
 }
 
-void action(sdbusplus::bus_t& bus, const std::string& path, bool assert)
+void Add::created(sdbusplus::message_t& msg)
 {
-    std::string service;
+    // Only the Associations property of the new entry is decoded, the other
+    // interfaces and properties are skipped.
+    const char* path = nullptr;
+    std::vector<std::string> frus;
     try
     {
-        std::string groups{ledGroups};
-        groups.pop_back();
-        service = getService(bus, groups);
+        auto* m = msg.get();
+        walker::checkSdBus(
+            sd_bus_message_read_basic(m, SD_BUS_TYPE_OBJECT_PATH, &path),
+            "read object path");
+        if (std::string_view(path).find(ELOG_ENTRY) == std::string_view::npos)
+        {
+            // Not a new error entry skip
+            return;
+        }
+        readEntryCallouts(m, frus);
     }
-    catch (const ResourceNotFoundErr& e)
+    catch (const sdbusplus::exception_t& e)
     {
-        commit<ResourceNotFoundErr>();
+        lg2::error("Failed to parse created message, ERROR = {ERROR}", "ERROR",
+                   e);
         return;
     }
 
-    auto pos = path.rfind('/');
-    if (pos == std::string::npos)
+    if (frus.empty())
     {
-        using namespace xyz::openbmc_project::Common;
-        report<InvalidArgumentErr>(
-            InvalidArgument::ARGUMENT_NAME("path"),
-            InvalidArgument::ARGUMENT_VALUE(path.c_str()));
         return;
     }
-    auto unit = path.substr(pos + 1);
-
-    std::string ledPath = ledGroups + unit + '_' + LED_FAULT;
 
-    auto method = bus.new_method_call(service.c_str(), ledPath.c_str(),
-                                      "org.freedesktop.DBus.Properties", "Set");
-    method.append(LedGroup::interface);
-    method.append(LedGroup::property_names::asserted);
+    // Nothing else shows when a specific error log
+    // has been created. Do it here.
+    lg2::debug("{PATH} created", "PATH", path);
 
-    method.append(std::variant<bool>(assert));
+    apply(callouts.set(path, std::move(frus)));
+}
 
+void Add::removed(sdbusplus::message_t& msg)
+{
+    sdbusplus::object_path objectPath;
     try
     {
-        bus.call_noreply(method);
+        msg.read(objectPath);
     }
     catch (const sdbusplus::exception_t& e)
     {
-        // Log an info message, system may not have all the LED Groups defined
-        lg2::info("Failed to Assert LED Group, ERROR = {ERROR}", "ERROR", e);
+        lg2::error("Failed to parse removed message, ERROR = {ERROR}", "ERROR",
+                   e);
+        return;
     }
 
-    return;
+    apply(callouts.remove(objectPath));
 }
 
-void Add::created(sdbusplus::message_t& msg)
+void Add::changed(sdbusplus::message_t& msg)
 {
-    auto bus = msg.get_bus();
+    std::string entry = msg.get_path();
+    if (entry.find(ELOG_ENTRY) == std::string::npos)
+    {
+        // Not an error entry
+        return;
+    }
 
-    sdbusplus::object_path objectPath;
-    InterfaceMap interfaces;
+    std::string intf;
+    std::unordered_map<std::string, std::variant<AssociationList>> properties;
     try
     {
-        msg.read(objectPath, interfaces);
+        msg.read(intf, properties);
     }
     catch (const sdbusplus::exception_t& e)
     {
-        lg2::error("Failed to parse created message, ERROR = {ERROR}", "ERROR",
+        lg2::error("Failed to parse changed message, ERROR = {ERROR}", "ERROR",
                    e);
         return;
     }
 
-    std::size_t found = objectPath.str.find(ELOG_ENTRY);
-    if (found == std::string::npos)
+    auto it =
+        properties.find(AssociationDefinitions::property_names::associations);
+    if (it == properties.end())
     {
-        // Not a new error entry skip
         return;
     }
-    auto iter = interfaces.find(AssociationDefinitions::interface);
-    if (iter == interfaces.end())
+
+    // The associations of a resolved entry are cleared, its FRUs are
+    // released
+    std::vector<std::string> frus;
+    for (const auto& [forward, reverse, endpoint] :
+         std::get<AssociationList>(it->second))
     {
-        return;
+        if (reverse == CALLOUT_REV_ASSOCIATION)
+        {
+            frus.emplace_back(endpoint);
+        }
     }
 
-    // Nothing else shows when a specific error log
-    // has been created. Do it here.
-    lg2::debug("{PATH} created", "PATH", objectPath);
+    apply(callouts.set(entry, std::move(frus)));
+}
 
-    auto attr =
-        iter->second.find(AssociationDefinitions::property_names::associations);
-    if (attr == iter->second.end())
+Callouts::Changes Callouts::set(const std::string& entry,
+                                std::vector<std::string> frus)
+{
+    std::ranges::sort(frus);
+    auto [first, last] = std::ranges::unique(frus);
+    frus.erase(first, last);
+
+    std::vector<std::string> previous;
+    auto it = entryCallouts.find(entry);
+    if (it != entryCallouts.end())
     {
-        return;
+        previous = std::move(it->second);
+        entryCallouts.erase(it);
     }
 
-    auto& assocs = std::get<AssociationList>(attr->second);
+    Changes changes;
+    std::vector<std::string> added;
+    std::ranges::set_difference(frus, previous, std::back_inserter(added));
+    for (auto& fru : added)
+    {
+        if (++fruRefs[fru] == 1)
+        {
+            changes.faulted.emplace_back(std::move(fru));
+        }
+    }
 
-    for (const auto& item : assocs)
+    std::vector<std::string> removed;
+    std::ranges::set_difference(previous, frus, std::back_inserter(removed));
+    for (auto& fru : removed)
     {
-        if (std::get<1>(item) == CALLOUT_REV_ASSOCIATION)
+        auto ref = fruRefs.find(fru);
+        if (ref != fruRefs.end() && --ref->second == 0)
         {
-            removeWatches.emplace_back(
-                std::make_unique<Remove>(bus, std::get<2>(item)));
-            action(bus, std::get<2>(item), true);
+            fruRefs.erase(ref);
+            changes.cleared.emplace_back(std::move(fru));
         }
     }
 
-    return;
+    if (!frus.empty())
+    {
+        entryCallouts.emplace(entry, std::move(frus));
+    }
+
+    return changes;
 }
 
-void getLoggingSubTree(sdbusplus::bus_t& bus, MapperResponseType& subtree)
+void Add::processExistingCallouts()
 {
-    auto depth = 0;
-    auto mapperCall = bus.new_method_call(
+    // Find the logging service, then fetch all the entries with a single
+    // call, instead of looking up each entry and its associations
+    // separately. The calls do not block the event loop.
+    auto mapper = bus.new_method_call(
         ObjectMapper::default_service, ObjectMapper::instance_path,
-        ObjectMapper::interface, ObjectMapper::method_names::get_sub_tree);
-    mapperCall.append("/");
-    mapperCall.append(depth);
-    mapperCall.append(std::vector<Interface>({LoggingEntry::interface}));
+        ObjectMapper::interface, ObjectMapper::method_names::get_object);
+    mapper.append(loggingPath, std::vector<std::string>({objMgrIntf}));
 
     try
     {
-        auto mapperResponseMsg = bus.call(mapperCall);
-        mapperResponseMsg.read(subtree);
+        scan = bus.call_async(mapper, [this](sdbusplus::message_t& reply) {
+            loggingServiceFound(reply);
+        });
     }
     catch (const sdbusplus::exception_t& e)
     {
         lg2::error(
-            "Failed to parse existing callouts subtree message, ERROR = {ERROR}",
-            "ERROR", e);
+            "Failed to find the logging service, ERROR = {ERROR}, PATH = {PATH}",
+            "ERROR", e, "PATH", loggingPath);
     }
 }
 
-void Add::processExistingCallouts(sdbusplus::bus_t& bus)
+void Add::loggingServiceFound(sdbusplus::message_t& reply)
 {
-    MapperResponseType mapperResponse;
-
-    getLoggingSubTree(bus, mapperResponse);
+    std::unordered_map<std::string, std::vector<std::string>> mapperResponse;
+    try
+    {
+        if (!reply.is_method_error())
+        {
+            reply.read(mapperResponse);
+        }
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error(
+            "Failed to parse getService mapper response, ERROR = {ERROR}",
+            "ERROR", e);
+    }
     if (mapperResponse.empty())
     {
-        // No errors to process.
+        lg2::error("Failed to find the logging service, PATH = {PATH}", "PATH",
+                   loggingPath);
+        scan.reset();
         return;
     }
 
-    for (const auto& elem : mapperResponse)
+    auto method =
+        bus.new_method_call(mapperResponse.cbegin()->first.c_str(),
+                            loggingPath, objMgrIntf, "GetManagedObjects");
+
+    // The slot is replaced in its own callback, sd-bus holds a reference
+    // while the callback runs.
+    try
+    {
+        scan = bus.call_async(method, [this](sdbusplus::message_t& reply) {
+            calloutsLoaded(reply);
+        });
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error(
+            "Failed to get existing callouts managed objects, ERROR = {ERROR}",
+            "ERROR", e);
+        scan.reset();
+    }
+}
+
+void Add::calloutsLoaded(sdbusplus::message_t& reply)
+{
+    CalloutMap existing;
+    try
     {
-        auto method = bus.new_method_call(
-            elem.second.begin()->first.c_str(), elem.first.c_str(),
-            "org.freedesktop.DBus.Properties", "Get");
-        method.append(AssociationDefinitions::interface);
-        method.append(AssociationDefinitions::property_names::associations);
-
-        std::variant<AssociationList> assoc;
-        try
+        if (reply.is_method_error())
         {
-            auto reply = bus.call(method);
-            reply.read(assoc);
+            lg2::error("Failed to get existing callouts managed objects");
         }
-        catch (const sdbusplus::exception_t& e)
+        else
         {
-            lg2::error(
-                "Failed to parse existing callouts associations message, ERROR = {ERROR}",
-                "ERROR", e);
-            continue;
+            existing = readManagedCallouts(reply);
         }
-        auto& assocs = std::get<AssociationList>(assoc);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error(
+            "Failed to parse existing callouts managed objects, ERROR = {ERROR}",
+            "ERROR", e);
+        existing.clear();
+    }
+    scan.reset();
 
-        for (const auto& item : assocs)
-        {
-            if (std::get<1>(item) == CALLOUT_REV_ASSOCIATION)
-            {
-                removeWatches.emplace_back(
-                    std::make_unique<Remove>(bus, std::get<2>(item)));
-                action(bus, std::get<2>(item), true);
-            }
-        }
+    if (existing.empty())
+    {
+        // No errors to process.
+        return;
     }
-}
 
-void Remove::removed(sdbusplus::message_t& msg)
-{
-    auto bus = msg.get_bus();
+    // Several entries commonly call out the same FRU, assert each FRU once.
+    // The signals received meanwhile are older than the reply, the entries
+    // are set to their latest callouts.
+    size_t faulted = 0;
+    for (auto& [entry, frus] : existing)
+    {
+        auto changes = callouts.set(entry, std::move(frus));
+        faulted += changes.faulted.size();
+        apply(changes);
+    }
 
-    action(bus, inventoryPath, false);
-    return;
+    lg2::info("Processed existing callouts, ENTRIES = {ENTRIES}, FRUS = {FRUS}",
+              "ENTRIES", existing.size(), "FRUS", faulted);
 }
 
 } // namespace monitor
@@ -2,10 +2,16 @@
 
 #include "config.h"
 
+#include "group-updater.hpp"
+
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/server.hpp>
+#include <xyz/openbmc_project/Association/Definitions/common.hpp>
 
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace phosphor
 {
@@ -18,71 +24,67 @@ namespace fault
 namespace monitor
 {
 
-/** @brief Assert or deassert an LED based on the input FRU
- *  @param[in] bus       -  The Dbus bus object
- *  @param[in] path      -  Inventory path of the FRU
- *  @param[in] assert    -  Assert if true deassert if false
- */
-void action(sdbusplus::bus_t& bus, const std::string& path, bool assert);
-
-/** @class Remove
- *  @brief Implementation of LED handling after resolution of FRU fault
- *  @details Implement methods for watching the resolution of FRU faults
- *  and deasserting corresponding LED.
+/** @class Callouts
+ *  @brief The FRUs called out by the log entries
+ *  @details A FRU stays faulted as long as one log entry calls it out. The
+ *  callouts of an entry are replaced when its associations change, the
+ *  associations of a resolved entry are cleared.
  */
-class Remove
+class Callouts
 {
   public:
-    Remove() = delete;
-    ~Remove() = default;
-    Remove(const Remove&) = delete;
-    Remove& operator=(const Remove&) = delete;
-    Remove(Remove&&) = default;
-    Remove& operator=(Remove&&) = default;
-
-    /** @brief constructs Remove
-     *  @param[in] bus  -  The Dbus bus object
-     *  @param[in] path -  Inventory path to fru
-     */
-    Remove(sdbusplus::bus_t& bus, const std::string& path) :
-        inventoryPath(path),
-        matchRemoved(bus, match(path),
-                     [this](sdbusplus::message_t& m) { removed(m); })
+    /** @brief The FRUs whose fault changed */
+    struct Changes
     {
-        // Do nothing
-    }
-
-  private:
-    /** @brief inventory path of the FRU */
-    std::string inventoryPath;
-
-    /** @brief sdbusplus signal matches for fault removed */
-    sdbusplus::bus::match_t matchRemoved;
+        /** @brief The FRUs which were not faulted before */
+        std::vector<std::string> faulted;
+
+        /** @brief The FRUs which are no longer faulted */
+        std::vector<std::string> cleared;
+    };
+
+    /** @brief Set the FRUs called out by a log entry
+     *  @param[in] entry - Path of the log entry
+     *  @param[in] frus  - Inventory paths of the FRUs called out, empty when
+     *                     the entry calls out no FRU
+     *
+     *  @return The FRUs whose fault changed
+     */
+    Changes set(const std::string& entry, std::vector<std::string> frus);
 
-    /** @brief Callback function for fru fault created
-     *  @param[in] msg       - Data associated with subscribed signal
+    /** @brief Stop tracking the FRUs called out by a log entry
+     *  @param[in] entry - Path of the log entry
+     *
+     *  @return The FRUs whose fault changed
      */
-    void removed(sdbusplus::message_t& msg);
+    Changes remove(const std::string& entry)
+    {
+        return set(entry, {});
+    }
 
-    /** @brief function to create fault remove match for a fru
-     *  @param[in] path  - Inventory path of the faulty unit.
+    /** @brief Whether a FRU is called out by a log entry
+     *  @param[in] fru - Inventory path of the FRU
      */
-    static std::string match(const std::string& path)
+    bool isFaulted(const std::string& fru) const
     {
-        namespace MatchRules = sdbusplus::bus::match::rules;
+        return fruRefs.contains(fru);
+    }
 
-        std::string matchStmt =
-            MatchRules::interfacesRemoved() +
-            MatchRules::argNpath(0, path + "/" + CALLOUT_REV_ASSOCIATION);
+  private:
+    /** @brief The FRUs called out by each log entry, sorted */
+    std::unordered_map<std::string, std::vector<std::string>> entryCallouts;
 
-        return matchStmt;
-    }
+    /** @brief The number of log entries calling out each FRU */
+    std::unordered_map<std::string, size_t> fruRefs;
 };
 
 /** @class Add
  *  @brief Implementation of LED handling during FRU fault
  *  @details This implements methods for watching for a FRU fault
- *  being logged to assert the corresponding LED
+ *  being logged to assert the corresponding LED, and for the resolution
+ *  of the fault to deassert it. A fault is resolved when the log entry is
+ *  deleted, or when its associations are cleared as the entry is marked
+ *  resolved.
  */
 class Add
 {
@@ -91,37 +93,114 @@ class Add
     ~Add() = default;
     Add(const Add&) = delete;
     Add& operator=(const Add&) = delete;
-    Add(Add&&) = default;
-    Add& operator=(Add&&) = default;
+    Add(Add&&) = delete;
+    Add& operator=(Add&&) = delete;
 
     /** @brief constructs Add a watch for FRU faults.
-     *  @param[in] bus -  The Dbus bus object
+     *  @param[in] bus     -  The Dbus bus object
+     *  @param[in] updater -  Updater of the LED groups
      */
-    explicit Add(sdbusplus::bus_t& bus) :
+    Add(sdbusplus::bus_t& bus, GroupUpdater& updater) :
+        bus(bus), updater(updater),
         matchCreated(bus,
                      sdbusplus::bus::match::rules::interfacesAdded() +
-                         sdbusplus::bus::match::rules::path_namespace(
-                             "/xyz/openbmc_project/logging"),
-                     [this](sdbusplus::message_t& m) { created(m); })
+                         entryMatch(),
+                     [this](sdbusplus::message_t& m) { created(m); }),
+        matchRemoved(bus,
+                     sdbusplus::bus::match::rules::interfacesRemoved() +
+                         entryMatch(),
+                     [this](sdbusplus::message_t& m) { removed(m); }),
+        matchChanged(bus,
+                     sdbusplus::bus::match::rules::propertiesChangedNamespace(
+                         "/xyz/openbmc_project/logging",
+                         sdbusplus::common::xyz::openbmc_project::association::
+                             Definitions::interface),
+                     [this](sdbusplus::message_t& m) { changed(m); })
     {
-        processExistingCallouts(bus);
+        processExistingCallouts();
     }
 
   private:
+    /** @brief The Dbus bus object */
+    sdbusplus::bus_t& bus;
+
+    /** @brief Updater of the LED groups */
+    GroupUpdater& updater;
+
     /** @brief sdbusplus signal match for fault created */
     sdbusplus::bus::match_t matchCreated;
 
-    std::vector<std::unique_ptr<Remove>> removeWatches;
+    /** @brief sdbusplus signal match for fault removed */
+    sdbusplus::bus::match_t matchRemoved;
+
+    /** @brief sdbusplus signal match for the associations of a log entry
+     *         changed */
+    sdbusplus::bus::match_t matchChanged;
+
+    /** @brief The FRUs called out by the log entries */
+    Callouts callouts;
+
+    /** @brief The call of the startup scan in flight */
+    std::optional<sdbusplus::slot_t> scan;
+
+    /** @brief function to match the signals about the log entries only */
+    static std::string entryMatch()
+    {
+        namespace MatchRules = sdbusplus::bus::match::rules;
+
+        std::string matchStmt =
+            MatchRules::path_namespace("/xyz/openbmc_project/logging") +
+            MatchRules::argNpath(
+                0, std::string("/xyz/openbmc_project/logging/") + ELOG_ENTRY +
+                       "/");
+
+        return matchStmt;
+    }
 
     /** @brief Callback function for fru fault created
      *  @param[in] msg       - Data associated with subscribed signal
      */
     void created(sdbusplus::message_t& msg);
 
-    /** @brief This function process all callouts at application start
-     *  @param[in] bus - The Dbus bus object
+    /** @brief Callback function for fru fault removed
+     *  @param[in] msg       - Data associated with subscribed signal
+     */
+    void removed(sdbusplus::message_t& msg);
+
+    /** @brief Callback function for the associations of a log entry changed
+     *  @param[in] msg       - Data associated with subscribed signal
+     */
+    void changed(sdbusplus::message_t& msg);
+
+    /** @brief This function process all callouts at application start,
+     *         the logging service is looked up and the entries fetched
+     *         without blocking
+     */
+    void processExistingCallouts();
+
+    /** @brief Callback function for the logging service found, the entries
+     *         are fetched
+     *  @param[in] reply     - Reply of the mapper
+     */
+    void loggingServiceFound(sdbusplus::message_t& reply);
+
+    /** @brief Callback function for the entries fetched, the FRUs called out
+     *         are asserted
+     *  @param[in] reply     - Reply of the logging service
+     */
+    void calloutsLoaded(sdbusplus::message_t& reply);
+
+    /** @brief Assert the LEDs of the FRUs faulted and deassert those of the
+     *         FRUs cleared
+     *  @param[in] changes - The FRUs whose fault changed
+     */
+    void apply(const Callouts::Changes& changes);
+
+    /** @brief Assert or deassert an LED based on the input FRU
+     *  @param[in] path      -  Inventory path of the FRU
+     *  @param[in] assert    -  Assert if true deassert if false
      */
-    void processExistingCallouts(sdbusplus::bus_t& bus);
+    void action(const std::string& path, bool assert);
 };
 } // namespace monitor
 } // namespace fault
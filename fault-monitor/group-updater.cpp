@@ -0,0 +1,622 @@
+#include "group-updater.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/exception.hpp>
+#include <xyz/openbmc_project/Led/Group/common.hpp>
+#include <xyz/openbmc_project/ObjectMapper/common.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+using ObjectMapper = sdbusplus::common::xyz::openbmc_project::ObjectMapper;
+using LedGroup = sdbusplus::common::xyz::openbmc_project::led::Group;
+
+namespace phosphor
+{
+namespace led
+{
+
+static constexpr auto objMgrIntf = "org.freedesktop.DBus.ObjectManager";
+static constexpr auto ledGroupsPath = "/xyz/openbmc_project/led/groups";
+
+/** @brief Delay before retrying when the LED group manager is not found */
+static constexpr auto retryInterval = std::chrono::seconds(1);
+
+/** @brief Maximum delay between the retries of a failed write */
+static constexpr auto maxRetryInterval = std::chrono::seconds(60);
+
+/** @brief Maximum number of writes in flight */
+static constexpr size_t maxInFlight = 8;
+
+void GroupUpdater::set(const std::string& group, bool assert)
+{
+    auto prev = requested.find(group);
+    bool changed = prev == requested.end() ? assert : prev->second != assert;
+    requested[group] = assert;
+    pending.emplace(group);
+
+    bool frozen = false;
+    if (changed && damping.maxTransitions != 0)
+    {
+        auto& flap = flaps[group];
+        decay(flap, Clock::now());
+        flap.penalty += 1;
+        if (!flap.frozen && flap.penalty > damping.maxTransitions)
+        {
+            flap.frozen = true;
+            lg2::info(
+                "Dampening flapping LED group, GROUP = {GROUP}, DAMPENED = {DAMPENED}",
+                "GROUP", group, "DAMPENED", dampened);
+        }
+        if (flap.frozen)
+        {
+            ++flap.held;
+        }
+        frozen = flap.frozen;
+    }
+
+    // Deasserted before the asserted group was held for the minimum time
+    bool held = holds.contains(group);
+    if (changed && !assert && !held && damping.minHold.count() > 0)
+    {
+        auto prev = written.find(group);
+        auto flap = flaps.find(group);
+        held = prev != written.end() && prev->second && flap != flaps.end() &&
+               Clock::now() < flap->second.assertedAt + damping.minHold;
+    }
+
+    // Changes of frozen groups, or changed back before the hold time elapsed
+    if (changed && (frozen || held))
+    {
+        ++dampened;
+    }
+
+    schedule(window);
+}
+
+void GroupUpdater::reportStats()
+{
+    std::pair current{dampened, suppressed};
+    if (current == reported)
+    {
+        return;
+    }
+    reported = current;
+
+    size_t frozen = std::ranges::count_if(
+        flaps, [](const auto& flap) { return flap.second.frozen; });
+    lg2::info(
+        "LED group update statistics, DAMPENED = {DAMPENED}, SUPPRESSED = {SUPPRESSED}, FROZEN = {FROZEN}, RETRYING = {RETRYING}",
+        "DAMPENED", dampened, "SUPPRESSED", suppressed, "FROZEN", frozen,
+        "RETRYING", retries.size());
+}
+
+void GroupUpdater::schedule(std::chrono::milliseconds delay)
+{
+    if (!timer.isEnabled() || timer.getRemaining() > delay)
+    {
+        timer.restartOnce(delay);
+    }
+}
+
+void GroupUpdater::decay(Flap& flap, Clock::time_point now) const
+{
+    if (damping.halfLife.count() > 0)
+    {
+        std::chrono::duration<double> elapsed = now - flap.updated;
+        std::chrono::duration<double> halfLife = damping.halfLife;
+        flap.penalty *= std::exp2(-elapsed / halfLife);
+    }
+    flap.updated = now;
+}
+
+std::optional<GroupUpdater::Clock::time_point> GroupUpdater::heldUntil(
+    const std::string& group, bool assert, Clock::time_point now)
+{
+    auto it = flaps.find(group);
+    if (it == flaps.end())
+    {
+        return std::nullopt;
+    }
+    auto& flap = it->second;
+
+    if (flap.frozen)
+    {
+        // Released once the penalty decays to half the limit
+        decay(flap, now);
+        double reuse = damping.maxTransitions / 2.0;
+        if (flap.penalty > reuse && damping.halfLife.count() > 0)
+        {
+            auto wait = std::chrono::duration<double>(damping.halfLife) *
+                        std::log2(flap.penalty / reuse);
+            return now +
+                   std::chrono::ceil<std::chrono::milliseconds>(wait);
+        }
+
+        lg2::info(
+            "LED group stable again, GROUP = {GROUP}, HELD = {HELD}, DAMPENED = {DAMPENED}",
+            "GROUP", group, "HELD", flap.held, "DAMPENED", dampened);
+        flap.frozen = false;
+        flap.held = 0;
+    }
+
+    auto prev = written.find(group);
+    if (!assert && prev != written.end() && prev->second &&
+        now < flap.assertedAt + damping.minHold)
+    {
+        return flap.assertedAt + damping.minHold;
+    }
+
+    return std::nullopt;
+}
+
+void GroupUpdater::flush()
+{
+    if (lookup)
+    {
+        // Flushed once the mapper replies
+        return;
+    }
+
+    if (!setter && service.empty())
+    {
+        resolveService();
+        return;
+    }
+
+    if (serviceStopped)
+    {
+        // Written again once the LED group manager starts
+        return;
+    }
+
+    auto now = Clock::now();
+    std::optional<Clock::time_point> next;
+    std::unordered_set<std::string> stillPending;
+
+    size_t writes = 0;
+    for (const auto& group : pending)
+    {
+        auto it = requested.find(group);
+        if (it == requested.end())
+        {
+            holds.erase(group);
+            continue;
+        }
+        bool assert = it->second;
+
+        auto until = heldUntil(group, assert, now);
+        if (until)
+        {
+            holds[group] = *until;
+            stillPending.emplace(group);
+            next = next ? std::min(*next, *until) : *until;
+            continue;
+        }
+        if (holds.erase(group) != 0)
+        {
+            lg2::debug("Released held LED group update, GROUP = {GROUP}",
+                       "GROUP", group);
+        }
+
+        auto prev = written.find(group);
+        if (groups && !groups->contains(group))
+        {
+            // Written once the group is added
+            if (prev == written.end() ? assert : prev->second != assert)
+            {
+                ++suppressed;
+            }
+            written.erase(group);
+            if (!assert)
+            {
+                requested.erase(it);
+            }
+            continue;
+        }
+
+        if (prev == written.end() ? assert : prev->second != assert)
+        {
+            auto retry = retries.find(group);
+            if (retry != retries.end() && now < retry->second.at)
+            {
+                // Written again once the backoff elapsed
+                stillPending.emplace(group);
+                next = next ? std::min(*next, retry->second.at)
+                            : retry->second.at;
+                continue;
+            }
+
+            if (!setter && (inFlight.contains(group) ||
+                            inFlight.size() >= maxInFlight))
+            {
+                // Written once a write in flight completes
+                stillPending.emplace(group);
+                continue;
+            }
+
+            if (!write(group, assert))
+            {
+                ++suppressed;
+                written.erase(group);
+                if (!assert)
+                {
+                    requested.erase(it);
+                }
+                continue;
+            }
+            ++writes;
+        }
+        else
+        {
+            retries.erase(group);
+        }
+
+        // Deasserted groups need no tracking
+        if (assert)
+        {
+            if (prev == written.end() || !prev->second)
+            {
+                if (damping.minHold.count() > 0 || damping.maxTransitions != 0)
+                {
+                    flaps[group].assertedAt = now;
+                }
+            }
+            written[group] = true;
+        }
+        else
+        {
+            written.erase(group);
+            requested.erase(it);
+
+            auto flap = flaps.find(group);
+            if (flap != flaps.end())
+            {
+                decay(flap->second, now);
+                if (!flap->second.frozen && flap->second.penalty < 0.5)
+                {
+                    flaps.erase(flap);
+                }
+            }
+        }
+    }
+
+    lg2::debug(
+        "Flushed LED group updates, UPDATES = {UPDATES}, WRITES = {WRITES}, SUPPRESSED = {SUPPRESSED}, HELD = {HELD}, DAMPENED = {DAMPENED}",
+        "UPDATES", pending.size(), "WRITES", writes, "SUPPRESSED", suppressed,
+        "HELD", stillPending.size(), "DAMPENED", dampened);
+    pending = std::move(stillPending);
+
+    // Write the held updates once they are stable
+    if (next)
+    {
+        auto delay = std::chrono::ceil<std::chrono::milliseconds>(*next - now);
+        schedule(std::max(delay, window));
+    }
+}
+
+bool GroupUpdater::write(const std::string& group, bool assert)
+{
+    if (setter)
+    {
+        return setter(group, assert);
+    }
+
+    auto method = bus.new_method_call(service.c_str(), group.c_str(),
+                                      "org.freedesktop.DBus.Properties", "Set");
+    method.append(LedGroup::interface);
+    method.append(LedGroup::property_names::asserted);
+    method.append(std::variant<bool>(assert));
+
+    try
+    {
+        auto slot = bus.call_async(
+            method, [this, group, assert](sdbusplus::message_t& reply) {
+                writeCompleted(group, assert, reply);
+            });
+        inFlight.emplace(group, std::move(slot));
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to send LED group write, ERROR = {ERROR}", "ERROR",
+                   e);
+        return false;
+    }
+
+    return true;
+}
+
+/** @brief Whether a write failed as the LED group does not exist
+ *
+ *  @param[in] reply - Reply of the write
+ */
+static bool isMissingGroup(const sdbusplus::message_t& reply)
+{
+    const auto* error = reply.get_error();
+    if (error == nullptr || error->name == nullptr)
+    {
+        return false;
+    }
+
+    std::string_view name = error->name;
+    return name == SD_BUS_ERROR_UNKNOWN_OBJECT ||
+           name == SD_BUS_ERROR_UNKNOWN_METHOD ||
+           name == SD_BUS_ERROR_UNKNOWN_INTERFACE ||
+           name == SD_BUS_ERROR_UNKNOWN_PROPERTY;
+}
+
+void GroupUpdater::writeCompleted(const std::string& group, bool assert,
+                                  sdbusplus::message_t& reply)
+{
+    // The slot is released in its own callback, sd-bus holds a reference
+    // while the callback runs.
+    inFlight.erase(group);
+
+    if (!reply.is_method_error())
+    {
+        retries.erase(group);
+    }
+    else if (isMissingGroup(reply))
+    {
+        // The group does not exist, it is written once it is added, system
+        // may not have all the LED Groups defined
+        lg2::debug("LED group not found, GROUP = {GROUP}", "GROUP", group);
+        ++suppressed;
+        retries.erase(group);
+        written.erase(group);
+
+        auto it = requested.find(group);
+        if (!assert && it != requested.end() && !it->second)
+        {
+            requested.erase(it);
+        }
+    }
+    else
+    {
+        // The group is not in the written state, write it again once the
+        // backoff elapsed. A deasserted group is no longer tracked, track it
+        // again as still asserted unless a newer update replaced it.
+        if (!assert && requested.try_emplace(group, false).second)
+        {
+            written[group] = true;
+        }
+        else
+        {
+            written.erase(group);
+        }
+
+        auto& retry = retries[group];
+        if (retry.delay.count() == 0)
+        {
+            lg2::info("Failed to Assert LED Group, GROUP = {GROUP}", "GROUP",
+                      group);
+            retry.delay = retryInterval;
+        }
+        else
+        {
+            lg2::debug(
+                "Failed to Assert LED Group, GROUP = {GROUP}, RETRY_MS = {RETRY_MS}",
+                "GROUP", group, "RETRY_MS", retry.delay.count());
+            retry.delay = std::min<std::chrono::milliseconds>(
+                retry.delay * 2, maxRetryInterval);
+        }
+        retry.at = Clock::now() + retry.delay;
+
+        if (requested.contains(group))
+        {
+            pending.emplace(group);
+        }
+    }
+
+    // The retried groups are held until their backoff elapsed
+    if (!pending.empty())
+    {
+        schedule(window);
+    }
+}
+
+void GroupUpdater::resolveService()
+{
+    auto mapper = bus.new_method_call(
+        ObjectMapper::default_service, ObjectMapper::instance_path,
+        ObjectMapper::interface, ObjectMapper::method_names::get_object);
+    mapper.append(ledGroupsPath, std::vector<std::string>({objMgrIntf}));
+
+    lookup = bus.call_async(
+        mapper, [this](sdbusplus::message_t& reply) { serviceResolved(reply); });
+}
+
+void GroupUpdater::serviceResolved(sdbusplus::message_t& reply)
+{
+    lookup.reset();
+
+    std::unordered_map<std::string, std::vector<std::string>> mapperResponse;
+    try
+    {
+        if (!reply.is_method_error())
+        {
+            reply.read(mapperResponse);
+        }
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error(
+            "Failed to parse the LED group manager lookup, ERROR = {ERROR}",
+            "ERROR", e);
+    }
+    if (mapperResponse.empty())
+    {
+        lg2::error("Failed to find the LED group manager, PATH = {PATH}",
+                   "PATH", ledGroupsPath);
+        schedule(retryInterval);
+        return;
+    }
+
+    service = mapperResponse.cbegin()->first;
+
+    // Track the owner of the service, the groups asserted by the monitor are
+    // lost when the LED group manager restarts.
+    namespace rules = sdbusplus::bus::match::rules;
+    ownerMatch.emplace(bus, rules::nameOwnerChanged(service),
+                       [this](sdbusplus::message_t& m) { ownerChanged(m); });
+
+    // Track the groups, the monitor only writes the groups which exist.
+    std::string groupsMatch = std::string(ledGroupsPath) + "/";
+    groupAddedMatch.emplace(
+        bus,
+        rules::interfacesAdded() + rules::sender(service) +
+            rules::argNpath(0, groupsMatch),
+        [this](sdbusplus::message_t& m) { groupAdded(m); });
+    groupRemovedMatch.emplace(
+        bus,
+        rules::interfacesRemoved() + rules::sender(service) +
+            rules::argNpath(0, groupsMatch),
+        [this](sdbusplus::message_t& m) { groupRemoved(m); });
+    loadGroups();
+}
+
+void GroupUpdater::loadGroups()
+{
+    auto mapper = bus.new_method_call(
+        ObjectMapper::default_service, ObjectMapper::instance_path,
+        ObjectMapper::interface,
+        ObjectMapper::method_names::get_sub_tree_paths);
+    mapper.append(ledGroupsPath, 0,
+                  std::vector<std::string>({LedGroup::interface}));
+
+    lookup = bus.call_async(
+        mapper, [this](sdbusplus::message_t& reply) { groupsLoaded(reply); });
+}
+
+void GroupUpdater::groupsLoaded(sdbusplus::message_t& reply)
+{
+    lookup.reset();
+
+    // Write all the groups on failure, as when the groups are not tracked
+    groups.reset();
+
+    std::vector<std::string> paths;
+    try
+    {
+        if (!reply.is_method_error())
+        {
+            reply.read(paths);
+            groups.emplace(std::make_move_iterator(paths.begin()),
+                           std::make_move_iterator(paths.end()));
+        }
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to parse the LED groups, ERROR = {ERROR}", "ERROR",
+                   e);
+    }
+
+    if (!groups)
+    {
+        lg2::error("Failed to get the LED groups, PATH = {PATH}", "PATH",
+                   ledGroupsPath);
+    }
+
+    if (!pending.empty())
+    {
+        schedule(window);
+    }
+}
+
+void GroupUpdater::groupAdded(sdbusplus::message_t& msg)
+{
+    sdbusplus::object_path path;
+    try
+    {
+        msg.read(path);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to parse group added message, ERROR = {ERROR}",
+                   "ERROR", e);
+        return;
+    }
+
+    // When the groups are unknown, the group may have failed to be written
+    if (groups && !groups->emplace(path.str).second)
+    {
+        return;
+    }
+
+    // Write the group when it was asserted before being added
+    if (requested.contains(path.str))
+    {
+        pending.emplace(path.str);
+        schedule(window);
+    }
+}
+
+void GroupUpdater::groupRemoved(sdbusplus::message_t& msg)
+{
+    sdbusplus::object_path path;
+    try
+    {
+        msg.read(path);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to parse group removed message, ERROR = {ERROR}",
+                   "ERROR", e);
+        return;
+    }
+
+    if (groups)
+    {
+        groups->erase(path.str);
+    }
+    written.erase(path.str);
+}
+
+void GroupUpdater::ownerChanged(sdbusplus::message_t& msg)
+{
+    std::string name;
+    std::string oldOwner;
+    std::string newOwner;
+    try
+    {
+        msg.read(name, oldOwner, newOwner);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to parse NameOwnerChanged message, ERROR = {ERROR}",
+                   "ERROR", e);
+        return;
+    }
+
+    if (newOwner.empty())
+    {
+        lg2::info("LED group manager stopped, SERVICE = {SERVICE}", "SERVICE",
+                  name);
+        serviceStopped = true;
+        return;
+    }
+
+    lg2::info("LED group manager started, SERVICE = {SERVICE}", "SERVICE",
+              name);
+
+    // The groups of the new instance may differ, write the asserted groups
+    // again
+    serviceStopped = false;
+    loadGroups();
+    written.clear();
+    retries.clear();
+    for (const auto& [group, assert] : requested)
+    {
+        pending.emplace(group);
+    }
+    if (!pending.empty())
+    {
+        schedule(window);
+    }
+}
+
+} // namespace led
+} // namespace phosphor
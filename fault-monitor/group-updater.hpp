@@ -0,0 +1,317 @@
+#pragma once
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/slot.hpp>
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/utility/timer.hpp>
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace phosphor
+{
+namespace led
+{
+
+/** @brief Hysteresis of the LED group updates */
+struct Dampening
+{
+    /** @brief Minimum time an asserted group stays asserted, 0 disables */
+    std::chrono::milliseconds minHold{0};
+
+    /** @brief Penalty above which the changes of a group are held, each
+     *         change adds 1 to the penalty, 0 disables */
+    size_t maxTransitions = 0;
+
+    /** @brief Half-life of the penalty */
+    std::chrono::milliseconds halfLife{0};
+};
+
+/** @class GroupUpdater
+ *  @brief Coalesce the updates of the LED groups
+ *  @details The requested states of the LED groups are collected during a
+ *  short window and only the groups whose state changed are written to the
+ *  LED group manager at the end of the window. The service of the LED group
+ *  manager is resolved once, and the asserted groups are written again when
+ *  the service restarts. Updates of groups which do not exist are not
+ *  written.
+ *
+ *  When the monitors run inside the LED group manager, the groups are set
+ *  directly through a GroupSetter instead of D-Bus.
+ *
+ *  The D-Bus calls are asynchronous, a bounded number of writes is in flight
+ *  at a time and at most one per group, so a slow mapper or LED group manager
+ *  does not hold up the signals of the monitors.
+ *
+ *  A failed write is retried with a growing backoff, and not at all while
+ *  the LED group manager is stopped, the asserted groups are written again
+ *  when it starts. A write to a group which does not exist is suppressed.
+ *
+ *  Flapping groups are dampened: an asserted group is held for a minimum
+ *  time, and a group changing state too often is frozen until its penalty
+ *  decays, only the stable state is then written.
+ *
+ *  The numbers of dampened and suppressed updates are exported to the
+ *  journal periodically, when they changed.
+ */
+class GroupUpdater
+{
+  public:
+    /** @brief Set an LED group directly
+     *
+     *  @param[in] group  - Path of the LED group
+     *  @param[in] assert - Assert if true deassert if false
+     *
+     *  @return false when the group does not exist
+     */
+    using GroupSetter = std::function<bool(const std::string&, bool)>;
+
+    GroupUpdater() = delete;
+    ~GroupUpdater() = default;
+    GroupUpdater(const GroupUpdater&) = delete;
+    GroupUpdater& operator=(const GroupUpdater&) = delete;
+    GroupUpdater(GroupUpdater&&) = delete;
+    GroupUpdater& operator=(GroupUpdater&&) = delete;
+
+    /** @brief Constructs GroupUpdater
+     *
+     *  @param[in] bus    - The Dbus bus object
+     *  @param[in] event  - sd event handler
+     *  @param[in] window - Time during which the updates are coalesced
+     *  @param[in] damping - Hysteresis of the updates
+     *  @param[in] setter - Set the groups directly, the groups are written
+     *                      over D-Bus when not set
+     */
+    GroupUpdater(sdbusplus::bus_t& bus, const sdeventplus::Event& event,
+                 std::chrono::milliseconds window, const Dampening& damping,
+                 GroupSetter setter = nullptr) :
+        bus(bus), window(window), damping(damping),
+        timer(event, [this](auto&) { flush(); }),
+        statsTimer(event, [this](auto&) { reportStats(); }, statsInterval),
+        setter(std::move(setter))
+    {}
+
+    /** @brief Request the state of an LED group
+     *
+     *  @param[in] group  - Path of the LED group
+     *  @param[in] assert - Assert if true deassert if false
+     */
+    void set(const std::string& group, bool assert);
+
+    /** @brief Get the number of changes not written as the group was
+     *         dampened */
+    size_t getDampenedTransitions() const
+    {
+        return dampened;
+    }
+
+    /** @brief Get the number of updates not written as the group does not
+     *         exist */
+    size_t getSuppressedUpdates() const
+    {
+        return suppressed;
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Interval of the statistics exported to the journal */
+    static constexpr std::chrono::minutes statsInterval{10};
+
+    /** @brief Flapping state of an LED group */
+    struct Flap
+    {
+        /** @brief Penalty of the changes of the group */
+        double penalty = 0;
+
+        /** @brief Last update of the penalty */
+        Clock::time_point updated{};
+
+        /** @brief Last time the group was written asserted */
+        Clock::time_point assertedAt{};
+
+        /** @brief Whether the changes of the group are held */
+        bool frozen = false;
+
+        /** @brief Number of changes held while frozen */
+        size_t held = 0;
+    };
+
+    /** @brief Retry state of a failed group write */
+    struct Retry
+    {
+        /** @brief Delay before the next retry */
+        std::chrono::milliseconds delay{0};
+
+        /** @brief Time of the next retry */
+        Clock::time_point at{};
+    };
+
+    /** @brief The Dbus bus object */
+    sdbusplus::bus_t& bus;
+
+    /** @brief Time during which the updates are coalesced */
+    std::chrono::milliseconds window;
+
+    /** @brief Hysteresis of the updates */
+    Dampening damping;
+
+    /** @brief Timer ending the coalescing window */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> timer;
+
+    /** @brief Timer exporting the statistics */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> statsTimer;
+
+    /** @brief The dampened and suppressed updates last exported */
+    std::pair<size_t, size_t> reported{0, 0};
+
+    /** @brief Set the groups directly, not set when written over D-Bus */
+    GroupSetter setter;
+
+    /** @brief The requested states of the LED groups */
+    std::unordered_map<std::string, bool> requested;
+
+    /** @brief The states written to the LED group manager */
+    std::unordered_map<std::string, bool> written;
+
+    /** @brief The LED groups updated during the window */
+    std::unordered_set<std::string> pending;
+
+    /** @brief Service of the LED group manager, empty when not resolved */
+    std::string service;
+
+    /** @brief The service has no owner, nothing is written until it
+     *         starts again */
+    bool serviceStopped = false;
+
+    /** @brief sdbusplus signal match for the owner of the service */
+    std::optional<sdbusplus::bus::match_t> ownerMatch;
+
+    /** @brief The mapper call in progress, the updates are not written
+     *         until it completes */
+    std::optional<sdbusplus::slot_t> lookup;
+
+    /** @brief The writes in flight, by group */
+    std::unordered_map<std::string, sdbusplus::slot_t> inFlight;
+
+    /** @brief The existing LED groups, not set when unknown */
+    std::optional<std::unordered_set<std::string>> groups;
+
+    /** @brief sdbusplus signal match for LED groups added */
+    std::optional<sdbusplus::bus::match_t> groupAddedMatch;
+
+    /** @brief sdbusplus signal match for LED groups removed */
+    std::optional<sdbusplus::bus::match_t> groupRemovedMatch;
+
+    /** @brief Number of updates not written as the group does not exist */
+    size_t suppressed = 0;
+
+    /** @brief Flapping state of the groups */
+    std::unordered_map<std::string, Flap> flaps;
+
+    /** @brief Groups whose update is held, and until when */
+    std::unordered_map<std::string, Clock::time_point> holds;
+
+    /** @brief Number of changes not written as the group was dampened */
+    size_t dampened = 0;
+
+    /** @brief Groups whose write failed, retried with a growing backoff */
+    std::unordered_map<std::string, Retry> retries;
+
+    /** @brief Export the numbers of dampened and suppressed updates to the
+     *         journal, when they changed */
+    void reportStats();
+
+    /** @brief Start the coalescing window, or shorten it to the delay */
+    void schedule(std::chrono::milliseconds delay);
+
+    /** @brief Decay the penalty of a group
+     *
+     *  @param[in] flap - Flapping state of the group
+     *  @param[in] now  - Current time
+     */
+    void decay(Flap& flap, Clock::time_point now) const;
+
+    /** @brief Get until when the update of a group is held
+     *
+     *  @param[in] group  - Path of the LED group
+     *  @param[in] assert - Requested state of the group
+     *  @param[in] now    - Current time
+     *
+     *  @return The time the update can be written, not set when it can be
+     *          written now
+     */
+    std::optional<Clock::time_point> heldUntil(const std::string& group,
+                                               bool assert,
+                                               Clock::time_point now);
+
+    /** @brief Write the updates of the window to the LED group manager */
+    void flush();
+
+    /** @brief Write the state of an LED group
+     *
+     *  @param[in] group  - Path of the LED group
+     *  @param[in] assert - Assert if true deassert if false
+     *
+     *  @return false when the group does not exist or the write was not sent
+     */
+    bool write(const std::string& group, bool assert);
+
+    /** @brief Callback function for a write completed, a failed write is
+     *         retried after a growing backoff, unless the group does not
+     *         exist
+     *
+     *  @param[in] group  - Path of the LED group
+     *  @param[in] assert - State written
+     *  @param[in] reply  - Reply of the write
+     */
+    void writeCompleted(const std::string& group, bool assert,
+                        sdbusplus::message_t& reply);
+
+    /** @brief Resolve the service of the LED group manager */
+    void resolveService();
+
+    /** @brief Callback function for the service of the LED group manager
+     *         resolved
+     *
+     *  @param[in] reply - Reply of the mapper
+     */
+    void serviceResolved(sdbusplus::message_t& reply);
+
+    /** @brief Get the existing LED groups from the LED group manager */
+    void loadGroups();
+
+    /** @brief Callback function for the existing LED groups loaded
+     *
+     *  @param[in] reply - Reply of the mapper
+     */
+    void groupsLoaded(sdbusplus::message_t& reply);
+
+    /** @brief Callback function for LED group added
+     *
+     *  @param[in] msg - Data associated with subscribed signal
+     */
+    void groupAdded(sdbusplus::message_t& msg);
+
+    /** @brief Callback function for LED group removed
+     *
+     *  @param[in] msg - Data associated with subscribed signal
+     */
+    void groupRemoved(sdbusplus::message_t& msg);
+
+    /** @brief Callback function for the owner of the service changed
+     *
+     *  @param[in] msg - Data associated with subscribed signal
+     */
+    void ownerChanged(sdbusplus::message_t& msg);
+};
+
+} // namespace led
+} // namespace phosphor
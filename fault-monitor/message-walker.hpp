@@ -0,0 +1,153 @@
+#pragma once
+
+#include <systemd/sd-bus.h>
+
+#include <sdbusplus/exception.hpp>
+
+#include <string_view>
+
+namespace phosphor
+{
+namespace led
+{
+namespace walker
+{
+
+/** @brief Helpers to decode parts of large D-Bus messages in place
+ *
+ *  The messages are walked with sd_bus_message enter/skip, only the values
+ *  the caller asks for are read and everything else is skipped without being
+ *  copied out of the message.
+ */
+
+/** @brief Throw on a failed sd-bus call
+ *  @param[in] r     - Return code of the call
+ *  @param[in] what  - Description of the call
+ */
+inline void checkSdBus(int r, const char* what)
+{
+    if (r < 0)
+    {
+        throw sdbusplus::exception::SdBusError(-r, what);
+    }
+}
+
+/** @brief Walk the associations of an Associations property value
+ *
+ *  The message is positioned at the "a(sss)" associations array.
+ *
+ *  @param[in] m       - The message
+ *  @param[in] handler - Called with the forward name, the reverse name and
+ *                       the endpoint of each association
+ */
+template <typename Handler>
+void walkAssociations(sd_bus_message* m, Handler&& handler)
+{
+    checkSdBus(sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "(sss)"),
+               "enter associations");
+    int r = 0;
+    while ((r = sd_bus_message_enter_container(m, SD_BUS_TYPE_STRUCT,
+                                               "sss")) > 0)
+    {
+        const char* forward = nullptr;
+        const char* reverse = nullptr;
+        const char* endpoint = nullptr;
+        checkSdBus(sd_bus_message_read(m, "sss", &forward, &reverse, &endpoint),
+                   "read association");
+        handler(std::string_view(forward), std::string_view(reverse),
+                std::string_view(endpoint));
+        checkSdBus(sd_bus_message_exit_container(m), "exit association");
+    }
+    checkSdBus(r, "enter association");
+    checkSdBus(sd_bus_message_exit_container(m), "exit associations");
+}
+
+/** @brief Walk the properties of the interfaces of an object
+ *
+ *  The message is positioned at the "a{sa{sv}}" interfaces array.
+ *
+ *  @param[in] m       - The message
+ *  @param[in] wanted  - Called with each interface name, the properties of
+ *                       the interface are skipped when it returns false
+ *  @param[in] handler - Called with the interface name, the property name
+ *                       and the message positioned at the "v" value. It
+ *                       returns false when it did not read the value, which
+ *                       is then skipped.
+ */
+template <typename Filter, typename Handler>
+void walkInterfaces(sd_bus_message* m, Filter&& wanted, Handler&& handler)
+{
+    checkSdBus(sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{sa{sv}}"),
+               "enter interfaces");
+    int r = 0;
+    while ((r = sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                               "sa{sv}")) > 0)
+    {
+        const char* intf = nullptr;
+        checkSdBus(sd_bus_message_read_basic(m, SD_BUS_TYPE_STRING, &intf),
+                   "read interface");
+        if (!wanted(std::string_view(intf)))
+        {
+            checkSdBus(sd_bus_message_skip(m, "a{sv}"), "skip interface");
+            checkSdBus(sd_bus_message_exit_container(m), "exit interface");
+            continue;
+        }
+
+        checkSdBus(sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{sv}"),
+                   "enter properties");
+        while ((r = sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                                   "sv")) > 0)
+        {
+            const char* property = nullptr;
+            checkSdBus(
+                sd_bus_message_read_basic(m, SD_BUS_TYPE_STRING, &property),
+                "read property");
+            if (!handler(std::string_view(intf), std::string_view(property),
+                         m))
+            {
+                checkSdBus(sd_bus_message_skip(m, "v"), "skip property");
+            }
+            checkSdBus(sd_bus_message_exit_container(m), "exit property");
+        }
+        checkSdBus(r, "enter property");
+        checkSdBus(sd_bus_message_exit_container(m), "exit properties");
+        checkSdBus(sd_bus_message_exit_container(m), "exit interface");
+    }
+    checkSdBus(r, "enter interface");
+    checkSdBus(sd_bus_message_exit_container(m), "exit interfaces");
+}
+
+/** @brief Walk the objects of a GetManagedObjects reply
+ *
+ *  @param[in] m       - The message
+ *  @param[in] handler - Called with the object path and the message
+ *                       positioned at the "a{sa{sv}}" interfaces array. It
+ *                       returns false when it did not read the interfaces,
+ *                       which are then skipped.
+ */
+template <typename Handler>
+void walkManagedObjects(sd_bus_message* m, Handler&& handler)
+{
+    checkSdBus(
+        sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{oa{sa{sv}}}"),
+        "enter objects");
+    int r = 0;
+    while ((r = sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                               "oa{sa{sv}}")) > 0)
+    {
+        const char* path = nullptr;
+        checkSdBus(sd_bus_message_read_basic(m, SD_BUS_TYPE_OBJECT_PATH, &path),
+                   "read object path");
+        if (!handler(std::string_view(path), m))
+        {
+            checkSdBus(sd_bus_message_skip(m, "a{sa{sv}}"), "skip object");
+        }
+        checkSdBus(sd_bus_message_exit_container(m), "exit object");
+    }
+    checkSdBus(r, "enter object");
+    checkSdBus(sd_bus_message_exit_container(m), "exit objects");
+}
+
+} // namespace walker
+} // namespace led
+} // namespace phosphor
@@ -3,20 +3,55 @@
 #include "fru-fault-monitor.hpp"
 #include "operational-status-monitor.hpp"
 
-int main(void)
+#include <CLI/CLI.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+
+int main(int argc, char** argv)
 {
+    CLI::App app("phosphor-fru-fault-monitor");
+
+    unsigned minHoldMs = FAULT_MONITOR_MIN_HOLD_MS;
+    app.add_option("--min-hold-ms", minHoldMs,
+                   "Minimum time an asserted LED group stays asserted");
+
+    size_t maxTransitions = FAULT_MONITOR_MAX_TRANSITIONS;
+    app.add_option("--max-transitions", maxTransitions,
+                   "Changes after which a flapping LED group is held, "
+                   "0 disables");
+
+    unsigned halfLifeMs = FAULT_MONITOR_HALF_LIFE_MS;
+    app.add_option("--half-life-ms", halfLifeMs,
+                   "Half-life of the changes of a flapping LED group");
+
+    CLI11_PARSE(app, argc, argv);
+
+    // Get a default event loop
+    auto event = sdeventplus::Event::get_default();
+
     /** @brief Dbus constructs used by Fault Monitor */
     sdbusplus::bus_t bus = sdbusplus::bus::new_default();
 
+    // Attach the bus to sd_event to service signals and timers
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+
+    /** @brief Coalesce and dampen the LED group updates of fault storms */
+    phosphor::led::GroupUpdater updater(
+        bus, event, std::chrono::milliseconds(FAULT_MONITOR_COALESCE_MS),
+        phosphor::led::Dampening{std::chrono::milliseconds(minHoldMs),
+                                 maxTransitions,
+                                 std::chrono::milliseconds(halfLifeMs)});
+
     if constexpr (MONITOR_OPERATIONAL_STATUS)
     {
-        phosphor::led::Operational::status::monitor::Monitor monitor(bus);
-        bus.process_loop();
+        phosphor::led::Operational::status::monitor::Monitor monitor(bus,
+                                                                     updater);
+        return event.loop();
     }
     else
     {
-        phosphor::led::fru::fault::monitor::Add monitor(bus);
-        bus.process_loop();
+        phosphor::led::fru::fault::monitor::Add monitor(bus, updater);
+        return event.loop();
     }
-    return 0;
 }
@@ -1,12 +1,20 @@
 #include "operational-status-monitor.hpp"
 
+#include "message-walker.hpp"
+
 #include <phosphor-logging/elog.hpp>
 #include <phosphor-logging/lg2.hpp>
 #include <xyz/openbmc_project/Association/common.hpp>
-#include <xyz/openbmc_project/Led/Group/common.hpp>
+#include <xyz/openbmc_project/ObjectMapper/common.hpp>
+#include <xyz/openbmc_project/State/Decorator/OperationalStatus/common.hpp>
+
+#include <optional>
+#include <string_view>
 
-using LedGroup = sdbusplus::common::xyz::openbmc_project::led::Group;
 using Association = sdbusplus::common::xyz::openbmc_project::Association;
+using ObjectMapper = sdbusplus::common::xyz::openbmc_project::ObjectMapper;
+using OperationalStatus =
+    sdbusplus::common::xyz::openbmc_project::state::decorator::OperationalStatus;
 
 namespace phosphor
 {
@@ -19,6 +27,272 @@ namespace status
 namespace monitor
 {
 
+static constexpr auto inventoryService = "xyz.openbmc_project.Inventory.Manager";
+static constexpr auto inventoryRoot = "/xyz/openbmc_project/inventory";
+static constexpr auto faultLedAssociation = "fault_identifying";
+
+/** @brief Maximum number of association lookups in flight */
+static constexpr size_t maxLookups = 8;
+
+/** @brief Get the inventory object of a fault LED association object
+ *
+ *  @param[in] path - Path of the association object
+ *
+ *  @return The inventory object path, empty for other associations
+ */
+static std::string getAssociationOwner(std::string_view path)
+{
+    auto pos = path.rfind('/');
+    if (pos == std::string_view::npos ||
+        path.substr(pos + 1) != faultLedAssociation)
+    {
+        return {};
+    }
+
+    return std::string(path.substr(0, pos));
+}
+
+/** @brief Read the Functional property of the interfaces of an inventory
+ *         object
+ *
+ *  The message is positioned at the "a{sa{sv}}" interfaces array, only the
+ *  Functional property is decoded.
+ *
+ *  @param[in] m           - The message
+ *  @param[out] functional - The Functional property, when implemented
+ */
+static void readFunctional(sd_bus_message* m, std::optional<bool>& functional)
+{
+    walker::walkInterfaces(
+        m,
+        [](std::string_view intf) {
+            return intf == OperationalStatus::interface;
+        },
+        [&functional](std::string_view, std::string_view property,
+                      sd_bus_message* msg) {
+            if (property != OperationalStatus::property_names::functional)
+            {
+                return false;
+            }
+
+            int value = 0;
+            walker::checkSdBus(sd_bus_message_read(msg, "v", "b", &value),
+                               "read functional");
+            functional = value != 0;
+            return true;
+        });
+}
+
+void Monitor::loadInventory()
+{
+    // The LED groups are the endpoints computed by the mapper, whichever
+    // side defines the associations. Find the fault LED association objects
+    // and look their endpoints up.
+    auto mapper = bus.new_method_call(
+        ObjectMapper::default_service, ObjectMapper::instance_path,
+        ObjectMapper::interface,
+        ObjectMapper::method_names::get_sub_tree_paths);
+    mapper.append(inventoryRoot, 0,
+                  std::vector<std::string>({Association::interface}));
+    try
+    {
+        associationScan = bus.call_async(
+            mapper, [this](sdbusplus::message_t& reply) {
+                associationsLoaded(reply);
+            });
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        // The LED groups are looked up when needed
+        lg2::error("Failed to find the inventory associations, ERROR = {ERROR}",
+                   "ERROR", e);
+    }
+
+    auto method = bus.new_method_call(inventoryService, inventoryRoot,
+                                      "org.freedesktop.DBus.ObjectManager",
+                                      "GetManagedObjects");
+    try
+    {
+        inventoryScan = bus.call_async(
+            method,
+            [this](sdbusplus::message_t& reply) { inventoryLoaded(reply); });
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to load the inventory, ERROR = {ERROR}", "ERROR",
+                   e);
+    }
+}
+
+void Monitor::associationsLoaded(sdbusplus::message_t& reply)
+{
+    std::vector<std::string> paths;
+    try
+    {
+        if (reply.is_method_error())
+        {
+            lg2::error("Failed to find the inventory associations");
+        }
+        else
+        {
+            reply.read(paths);
+        }
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error(
+            "Failed to parse the inventory associations, ERROR = {ERROR}",
+            "ERROR", e);
+    }
+
+    // The slot is released in its own callback, sd-bus holds a reference
+    // while the callback runs.
+    associationScan.reset();
+
+    size_t count = 0;
+    for (const auto& path : paths)
+    {
+        auto owner = getAssociationOwner(path);
+        if (owner.empty() || ledGroups.contains(owner))
+        {
+            continue;
+        }
+        lookupLedGroupPaths(owner, std::nullopt);
+        ++count;
+    }
+    lg2::info("Loading the inventory LED groups, COUNT = {COUNT}", "COUNT",
+              count);
+}
+
+void Monitor::inventoryLoaded(sdbusplus::message_t& reply)
+{
+    std::vector<std::string> nonFunctional;
+    try
+    {
+        if (reply.is_method_error())
+        {
+            lg2::error("Failed to load the inventory, PATH = {PATH}", "PATH",
+                       inventoryRoot);
+        }
+        else
+        {
+            walker::walkManagedObjects(
+                reply.get(),
+                [&nonFunctional](std::string_view path, sd_bus_message* m) {
+                    std::optional<bool> functional;
+                    readFunctional(m, functional);
+                    if (functional && !*functional)
+                    {
+                        nonFunctional.emplace_back(path);
+                    }
+                    return true;
+                });
+        }
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to parse the inventory, ERROR = {ERROR}", "ERROR",
+                   e);
+        nonFunctional.clear();
+    }
+
+    inventoryScan.reset();
+    lg2::info("Loaded the inventory, NON_FUNCTIONAL = {NON_FUNCTIONAL}",
+              "NON_FUNCTIONAL", nonFunctional.size());
+
+    // The objects marked non-functional before the monitor started have no
+    // change to react to, assert their LED groups now. The updates are
+    // written in one batch by the updater.
+    for (const auto& path : nonFunctional)
+    {
+        applyFunctional(path, false);
+    }
+}
+
+void Monitor::associationChanged(sdbusplus::message_t& msg)
+{
+    auto owner = getAssociationOwner(msg.get_path());
+    if (owner.empty())
+    {
+        return;
+    }
+
+    std::string interfaceName{};
+    std::unordered_map<std::string, std::variant<std::vector<std::string>>>
+        properties;
+    try
+    {
+        msg.read(interfaceName, properties);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to parse association message, ERROR = {ERROR}",
+                   "ERROR", e);
+        return;
+    }
+
+    auto it = properties.find(Association::property_names::endpoints);
+    if (it != properties.end())
+    {
+        ledGroups[owner] = std::get<std::vector<std::string>>(it->second);
+    }
+}
+
+void Monitor::associationAdded(sdbusplus::message_t& msg)
+{
+    sdbusplus::object_path path;
+    std::unordered_map<
+        std::string,
+        std::unordered_map<std::string,
+                           std::variant<std::vector<std::string>>>>
+        interfaces;
+    try
+    {
+        msg.read(path, interfaces);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to parse association message, ERROR = {ERROR}",
+                   "ERROR", e);
+        return;
+    }
+
+    auto owner = getAssociationOwner(path.str);
+    auto intf = interfaces.find(Association::interface);
+    if (owner.empty() || intf == interfaces.end())
+    {
+        return;
+    }
+
+    auto it = intf->second.find(Association::property_names::endpoints);
+    if (it != intf->second.end())
+    {
+        ledGroups[owner] = std::get<std::vector<std::string>>(it->second);
+    }
+}
+
+void Monitor::associationRemoved(sdbusplus::message_t& msg)
+{
+    sdbusplus::object_path path;
+    try
+    {
+        msg.read(path);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to parse association message, ERROR = {ERROR}",
+                   "ERROR", e);
+        return;
+    }
+
+    auto owner = getAssociationOwner(path.str);
+    if (!owner.empty())
+    {
+        // No LED groups
+        ledGroups[owner].clear();
+    }
+}
+
 void Monitor::matchHandler(sdbusplus::message_t& msg)
 {
     // Get the ObjectPath of the `xyz.openbmc_project.Inventory.Manager`
@@ -43,50 +317,135 @@ void Monitor::matchHandler(sdbusplus::message_t& msg)
             return;
         }
 
-        // See if the Inventory D-Bus object has an association with LED groups
-        // D-Bus object.
-        auto ledGroupPath = getLedGroupPaths(invObjectPath);
-        if (ledGroupPath.empty())
-        {
-            lg2::info(
-                "The inventory D-Bus object is not associated with the LED "
-                "group D-Bus object. INVENTORY_PATH = {PATH}",
-                "PATH", invObjectPath);
-            return;
-        }
+        applyFunctional(invObjectPath, *value);
+    }
+}
+
+void Monitor::applyFunctional(const std::string& inventoryPath, bool value)
+{
+    // See if the Inventory D-Bus object has an association with LED groups
+    // D-Bus object.
+    auto it = ledGroups.find(inventoryPath);
+    if (it == ledGroups.end())
+    {
+        lookupLedGroupPaths(inventoryPath, value);
+        return;
+    }
 
-        // Update the Asserted property by the Functional property value.
-        updateAssertedProperty(ledGroupPath, *value);
+    if (it->second.empty())
+    {
+        lg2::info("The inventory D-Bus object is not associated with the LED "
+                  "group D-Bus object. INVENTORY_PATH = {PATH}",
+                  "PATH", inventoryPath);
+        return;
     }
+
+    // Update the Asserted property by the Functional property value.
+    updateAssertedProperty(it->second, value);
 }
 
-std::vector<std::string> Monitor::getLedGroupPaths(
-    const std::string& inventoryPath)
+void Monitor::lookupLedGroupPaths(const std::string& inventoryPath,
+                                  std::optional<bool> value)
 {
-    // Get endpoints from fType
-    std::string faultLedAssociation = inventoryPath + "/fault_identifying";
+    // A lookup in progress applies the latest value
+    auto [it, added] = lookups.try_emplace(inventoryPath);
+    if (value)
+    {
+        it->second.functional = value;
+    }
+    if (!added)
+    {
+        return;
+    }
+
+    if (lookups.size() - lookupQueue.size() > maxLookups)
+    {
+        lookupQueue.emplace_back(inventoryPath);
+        return;
+    }
+
+    startLookup(inventoryPath);
+}
+
+void Monitor::startLookup(const std::string& inventoryPath)
+{
+    // Get endpoints from fType, the association objects are hosted by the
+    // mapper
+    std::string faultLedPath = inventoryPath + "/" + faultLedAssociation;
+
+    auto method = bus.new_method_call(ObjectMapper::default_service,
+                                      faultLedPath.c_str(),
+                                      "org.freedesktop.DBus.Properties", "Get");
+    method.append(Association::interface,
+                  Association::property_names::endpoints);
+
+    try
+    {
+        lookups[inventoryPath].call = bus.call_async(
+            method, [this, inventoryPath](sdbusplus::message_t& reply) {
+                lookupCompleted(inventoryPath, reply);
+            });
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error(
+            "Failed to get endpoints property, ERROR = {ERROR}, PATH = {PATH}",
+            "ERROR", e, "PATH", faultLedPath);
+        lookups.erase(inventoryPath);
+    }
+}
 
+void Monitor::lookupCompleted(const std::string& inventoryPath,
+                              sdbusplus::message_t& reply)
+{
     // endpoint contains the vector of strings, where each string is a Inventory
     // D-Bus object that this, associated with this LED Group D-Bus object
     // pointed to by fru_fault
-    PropertyValue endpoint{};
-
+    std::optional<std::vector<std::string>> endpoints;
     try
     {
-        endpoint = phosphor::led::utils::DBusHandler::getProperty(
-            faultLedAssociation, Association::interface,
-            Association::property_names::endpoints);
+        if (reply.is_method_error())
+        {
+            lg2::error("Failed to get endpoints property, PATH = {PATH}",
+                       "PATH", inventoryPath);
+        }
+        else
+        {
+            std::variant<std::vector<std::string>> endpoint;
+            reply.read(endpoint);
+            endpoints = std::get<std::vector<std::string>>(endpoint);
+        }
     }
     catch (const sdbusplus::exception_t& e)
     {
         lg2::error(
-            "Failed to get endpoints property, ERROR = {ERROR}, PATH = {PATH}",
-            "ERROR", e, "PATH", faultLedAssociation);
+            "Failed to parse endpoints property, ERROR = {ERROR}, PATH = {PATH}",
+            "ERROR", e, "PATH", inventoryPath);
+    }
 
-        return {};
+    // The slot is released in its own callback, sd-bus holds a reference
+    // while the callback runs.
+    auto node = lookups.extract(inventoryPath);
+
+    // A failed lookup is not cached, the next change of the FRU looks the
+    // LED groups up again. The association signals are more recent than the
+    // lookup.
+    if (endpoints)
+    {
+        ledGroups.try_emplace(inventoryPath, std::move(*endpoints));
+        if (!node.empty() && node.mapped().functional)
+        {
+            applyFunctional(inventoryPath, *node.mapped().functional);
+        }
     }
 
-    return std::get<std::vector<std::string>>(endpoint);
+    while (!lookupQueue.empty() &&
+           lookups.size() - lookupQueue.size() < maxLookups)
+    {
+        auto next = std::move(lookupQueue.front());
+        lookupQueue.pop_front();
+        startLookup(next);
+    }
 }
 
 void Monitor::updateAssertedProperty(
@@ -94,22 +453,10 @@ void Monitor::updateAssertedProperty(
 {
     for (const auto& path : ledGroupPaths)
     {
-        try
-        {
-            // Call "Group Asserted --> true" if the value of Functional is
-            // false Call "Group Asserted --> false" if the value of Functional
-            // is true
-            PropertyValue assertedValue{!value};
-            phosphor::led::utils::DBusHandler::setProperty(
-                path, LedGroup::interface, LedGroup::property_names::asserted,
-                assertedValue);
-        }
-        catch (const sdbusplus::exception_t& e)
-        {
-            lg2::error(
-                "Failed to set Asserted property, ERROR = {ERROR}, PATH = {PATH}",
-                "ERROR", e, "PATH", path);
-        }
+        // Call "Group Asserted --> true" if the value of Functional is
+        // false Call "Group Asserted --> false" if the value of Functional
+        // is true
+        updater.set(path, !value);
     }
 }
 } // namespace monitor
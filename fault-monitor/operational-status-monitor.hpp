@@ -1,10 +1,16 @@
 #pragma once
 
-#include "../utils.hpp"
+#include "group-updater.hpp"
 
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/server.hpp>
 
+#include <deque>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace phosphor
 {
 namespace led
@@ -15,15 +21,16 @@ namespace status
 {
 namespace monitor
 {
-using namespace phosphor::led::utils;
-
 /** @class Monitor
  *  @brief Implementation of LED handling during the change of the Functional
  *         property of the OperationalStatus interface
  *
  *  @details This implements methods for watching OperationalStatus interface of
  *           Inventory D-Bus object and then assert corresponding LED Group
- *           D-Bus objects.
+ *           D-Bus objects. The LED groups associated with the inventory
+ *           objects are cached, loaded at startup from the association
+ *           objects of the mapper and kept up to date by its association
+ *           signals. The startup scans do not block the event loop.
  */
 class Monitor
 {
@@ -32,28 +39,140 @@ class Monitor
     ~Monitor() = default;
     Monitor(const Monitor&) = delete;
     Monitor& operator=(const Monitor&) = delete;
-    Monitor(Monitor&&) = default;
+    Monitor(Monitor&&) = delete;
     Monitor& operator=(Monitor&&) = delete;
 
     /** @brief Add a watch for OperationalStatus.
      *
-     *  @param[in] bus -  D-Bus object
+     *  @param[in] bus     -  D-Bus object
+     *  @param[in] updater -  Updater of the LED groups
      */
-    explicit Monitor(sdbusplus::bus_t& bus) :
+    Monitor(sdbusplus::bus_t& bus, GroupUpdater& updater) :
+        bus(bus), updater(updater),
         matchSignal(bus,
                     "type='signal',member='PropertiesChanged', "
                     "interface='org.freedesktop.DBus.Properties', "
                     "sender='xyz.openbmc_project.Inventory.Manager', "
                     "arg0namespace='xyz.openbmc_project.State.Decorator."
                     "OperationalStatus'",
-                    [](sdbusplus::message_t& m) { matchHandler(m); })
-
-    {}
+                    [this](sdbusplus::message_t& m) { matchHandler(m); }),
+        matchAssociationChanged(
+            bus,
+            "type='signal',member='PropertiesChanged', "
+            "interface='org.freedesktop.DBus.Properties', "
+            "sender='xyz.openbmc_project.ObjectMapper', "
+            "path_namespace='/xyz/openbmc_project/inventory', "
+            "arg0='xyz.openbmc_project.Association'",
+            [this](sdbusplus::message_t& m) { associationChanged(m); }),
+        matchAssociationAdded(
+            bus,
+            "type='signal',member='InterfacesAdded', "
+            "interface='org.freedesktop.DBus.ObjectManager', "
+            "sender='xyz.openbmc_project.ObjectMapper', "
+            "arg0path='/xyz/openbmc_project/inventory/'",
+            [this](sdbusplus::message_t& m) { associationAdded(m); }),
+        matchAssociationRemoved(
+            bus,
+            "type='signal',member='InterfacesRemoved', "
+            "interface='org.freedesktop.DBus.ObjectManager', "
+            "sender='xyz.openbmc_project.ObjectMapper', "
+            "arg0path='/xyz/openbmc_project/inventory/'",
+            [this](sdbusplus::message_t& m) { associationRemoved(m); })
+    {
+        loadInventory();
+    }
 
   private:
+    /** @brief D-Bus object */
+    sdbusplus::bus_t& bus;
+
+    /** @brief Updater of the LED groups */
+    GroupUpdater& updater;
+
+    /** @brief The LED groups associated with each inventory object */
+    std::unordered_map<std::string, std::vector<std::string>> ledGroups;
+
+    /** @brief A lookup of the LED groups of an inventory object */
+    struct Lookup
+    {
+        /** @brief The latest Functional property value, not set when the
+         *         lookup only fills the cache */
+        std::optional<bool> functional;
+
+        /** @brief The call in flight, not set while queued */
+        std::optional<sdbusplus::slot_t> call;
+    };
+
+    /** @brief The lookups in flight or queued, by inventory object */
+    std::unordered_map<std::string, Lookup> lookups;
+
+    /** @brief The inventory objects whose lookup is queued */
+    std::deque<std::string> lookupQueue;
+
+    /** @brief The lookup of the fault LED association objects in flight */
+    std::optional<sdbusplus::slot_t> associationScan;
+
+    /** @brief The scan of the inventory in flight */
+    std::optional<sdbusplus::slot_t> inventoryScan;
+
     /** @brief sdbusplus signal matches for Monitor */
     sdbusplus::bus::match_t matchSignal;
 
+    /** @brief sdbusplus signal matches for the associations endpoints */
+    sdbusplus::bus::match_t matchAssociationChanged;
+
+    /** @brief sdbusplus signal matches for the associations added */
+    sdbusplus::bus::match_t matchAssociationAdded;
+
+    /** @brief sdbusplus signal matches for the associations removed */
+    sdbusplus::bus::match_t matchAssociationRemoved;
+
+    /**
+     * @brief Load the LED groups associated with the inventory objects from
+     *        the fault LED association objects of the mapper, and assert the
+     *        LED groups of the objects which are already not functional,
+     *        found with a single GetManagedObjects call. The calls are
+     *        asynchronous.
+     */
+    void loadInventory();
+
+    /**
+     * @brief Callback handler of the fault LED association objects found,
+     *        their endpoints are looked up to fill the cache
+     *
+     * @param[in] reply - Reply of the mapper
+     */
+    void associationsLoaded(sdbusplus::message_t& reply);
+
+    /**
+     * @brief Callback handler of the inventory loaded, the LED groups of the
+     *        objects which are not functional are asserted
+     *
+     * @param[in] reply - Reply of the inventory manager
+     */
+    void inventoryLoaded(sdbusplus::message_t& reply);
+
+    /**
+     * @brief Callback handler of the endpoints of an association changed
+     *
+     * @param[in] msg - The D-Bus message contents
+     */
+    void associationChanged(sdbusplus::message_t& msg);
+
+    /**
+     * @brief Callback handler of an association added
+     *
+     * @param[in] msg - The D-Bus message contents
+     */
+    void associationAdded(sdbusplus::message_t& msg);
+
+    /**
+     * @brief Callback handler of an association removed
+     *
+     * @param[in] msg - The D-Bus message contents
+     */
+    void associationRemoved(sdbusplus::message_t& msg);
+
     /**
      * @brief Callback handler that gets invoked when the PropertiesChanged
      *        signal is caught by this app. Message is scanned for Inventory
@@ -62,18 +181,47 @@ class Monitor
      *
      * @param[in] msg - The D-Bus message contents
      */
-    static void matchHandler(sdbusplus::message_t& msg);
+    void matchHandler(sdbusplus::message_t& msg);
+
+    /**
+     * @brief Update the LED groups associated with the Inventory D-Bus object
+     *        by its Functional property. The cache is used, the mapper is
+     *        only queried on a miss.
+     *
+     * @param[in] inventoryPath - Inventory D-Bus object path
+     * @param[in] value         - The Functional property value
+     */
+    void applyFunctional(const std::string& inventoryPath, bool value);
 
     /**
      * @brief From the Inventory D-Bus object, obtains the associated LED group
-     *        D-Bus object, where the association name is "fault_led_group"
+     *        D-Bus object, where the association name is "fault_led_group",
+     *        then applies the Functional property value. The lookups are
+     *        asynchronous and a bounded number is in flight.
      *
-     * @param[in] inventoryPath         - Inventory D-Bus object path
+     * @param[in] inventoryPath - Inventory D-Bus object path
+     * @param[in] value         - The Functional property value, not set to
+     *                            only fill the cache
+     */
+    void lookupLedGroupPaths(const std::string& inventoryPath,
+                             std::optional<bool> value);
+
+    /**
+     * @brief Send the lookup of the LED groups of an Inventory D-Bus object
+     *
+     * @param[in] inventoryPath - Inventory D-Bus object path
+     */
+    void startLookup(const std::string& inventoryPath);
+
+    /**
+     * @brief Callback handler of the lookup of the LED groups of an Inventory
+     *        D-Bus object
      *
-     * @return std::vector<std::string> - Vector of LED Group D-Bus object paths
+     * @param[in] inventoryPath - Inventory D-Bus object path
+     * @param[in] reply         - Reply of the lookup
      */
-    static std::vector<std::string> getLedGroupPaths(
-        const std::string& inventoryPath);
+    void lookupCompleted(const std::string& inventoryPath,
+                         sdbusplus::message_t& reply);
 
     /**
      * @brief Update the Asserted property of the LED Group Manager.
@@ -81,8 +229,8 @@ class Monitor
      * @param[in] ledGroupPaths   - LED Group D-Bus object Paths
      * @param[in] value           - The Asserted property value, True / False
      */
-    static void updateAssertedProperty(
-        const std::vector<std::string>& ledGroupPaths, bool value);
+    void updateAssertedProperty(const std::vector<std::string>& ledGroupPaths,
+                                bool value);
 };
 } // namespace monitor
 } // namespace status
@@ -18,16 +18,16 @@ using PriorityMap =
     std::unordered_map<std::string,
                        std::optional<phosphor::led::Layout::Action>>;
 
-static bool isUsingGroupPriority(const phosphor::led::GroupMap& ledMap)
+PriorityMode getPriorityMode(const phosphor::led::GroupMap& ledMap)
 {
     for (const auto& [_, group] : ledMap)
     {
         if (group.priority != 0)
         {
-            return true;
+            return PriorityMode::group;
         }
     }
-    return false;
+    return PriorityMode::led;
 }
 
 static std::string priorityToString(
@@ -161,9 +161,7 @@ static void validateConfigV1ForGroupPriority(
 
 void validateConfigV1(const GroupMap& ledMap)
 {
-    const bool useGroupPriority = isUsingGroupPriority(ledMap);
-
-    if (useGroupPriority)
+    if (getPriorityMode(ledMap) == PriorityMode::group)
     {
         validateConfigV1ForGroupPriority(ledMap);
     }
@@ -64,6 +64,25 @@ class ConfigValidationException : std::runtime_error
     }
 };
 
+/** @brief Rule choosing the action of an LED in several asserted groups */
+enum class PriorityMode
+{
+    // Each LED has a priority action winning over the other actions
+    led,
+
+    // The action of the group with the highest priority wins
+    group,
+};
+
+/** @brief Get the rule of a configuration, the groups use group priorities
+ *         when any of them has a priority
+ *
+ *  @param[in] ledMap - LEDs group layout
+ *
+ *  @return The rule of the configuration
+ */
+PriorityMode getPriorityMode(const phosphor::led::GroupMap& ledMap);
+
 void validateConfigV1(const phosphor::led::GroupMap& ledMap);
 
 } // namespace led
@@ -21,8 +21,7 @@ bool Group::asserted(bool value)
         {
             // If the lamp test request is handled successfully, update the
             // asserted property.
-            return sdbusplus::xyz::openbmc_project::Led::server::Group::
-                asserted(value);
+            return setAsserted(value);
         }
 
         // If the lamp test request is not handled successfully, return the
@@ -44,7 +43,9 @@ bool Group::asserted(bool value)
     // Group management is handled by Manager. The populated leds* sets are not
     // really used by production code. They are there to enable gtest for
     // validation.
-    auto result = manager.setGroupState(path, value, ledsAssert, ledsDeAssert);
+    auto result =
+        handle ? manager.setGroupState(*handle, value, ledsAssert, ledsDeAssert)
+               : manager.setGroupState(path, value, ledsAssert, ledsDeAssert);
 
     // Store asserted state
     if (serializePtr)
@@ -55,11 +56,24 @@ bool Group::asserted(bool value)
     // If something does not go right here, then there should be an sdbusplus
     // exception thrown.
     manager.driveLEDs(ledsAssert, ledsDeAssert);
+    manager.recycle(ledsAssert);
+    manager.recycle(ledsDeAssert);
 
     // Set the base class's asserted to 'true' since the getter
     // operation is handled there.
+    return setAsserted(result);
+}
+
+bool Group::setAsserted(bool value)
+{
+    if (objectsPtr)
+    {
+        objectsPtr->setAsserted(path, value);
+        return sdbusplus::xyz::openbmc_project::Led::server::Group::asserted(
+            value, true);
+    }
     return sdbusplus::xyz::openbmc_project::Led::server::Group::asserted(
-        result);
+        value);
 }
 
 } // namespace led
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "managed-objects.hpp"
 #include "manager.hpp"
 #include "serialize.hpp"
 
@@ -7,6 +8,7 @@
 #include <sdbusplus/server/object.hpp>
 #include <xyz/openbmc_project/Led/Group/server.hpp>
 
+#include <optional>
 #include <string>
 
 namespace phosphor
@@ -24,7 +26,13 @@ class Group : public GroupInherit
 {
   public:
     Group() = delete;
-    ~Group() override = default;
+    ~Group() override
+    {
+        if (objectsPtr)
+        {
+            objectsPtr->remove(path);
+        }
+    }
     Group(const Group&) = delete;
     Group& operator=(const Group&) = delete;
     Group(Group&&) = delete;
@@ -36,15 +44,18 @@ class Group : public GroupInherit
      * @param[in] objPath       - The D-Bus path that hosts LED group
      * @param[in] manager       - Reference to Manager
      * @param[in] serializePtr  - Serialize object
+     * @param[in] objectsPtr    - Cached reply of the object manager
      * @param[in] callBack      - Custom callback when LED group is asserted
      */
     Group(sdbusplus::bus_t& bus, const std::string& objPath, Manager& manager,
           std::shared_ptr<Serialize> serializePtr,
+          std::shared_ptr<ManagedObjects> objectsPtr,
           std::function<bool(Group*, bool)> callBack = nullptr) :
 
         GroupInherit(bus, objPath.c_str(), GroupInherit::action::defer_emit),
-        path(objPath), manager(manager), serializePtr(serializePtr),
-        customCallBack(callBack)
+        path(objPath), manager(manager),
+        handle(manager.findGroupHandle(objPath)), serializePtr(serializePtr),
+        objectsPtr(objectsPtr), customCallBack(callBack)
     {
         // Initialize Asserted property value
         if (serializePtr && serializePtr->getGroupSavedState(objPath))
@@ -52,8 +63,19 @@ class Group : public GroupInherit
             asserted(true);
         }
 
-        // Emit deferred signal.
-        emit_object_added();
+        // Emit deferred signal, with the next batch of the object manager
+        // when there is one.
+        if (objectsPtr)
+        {
+            objectsPtr->add(
+                path,
+                sdbusplus::xyz::openbmc_project::Led::server::Group::asserted(),
+                [this]() { emit_object_added(); });
+        }
+        else
+        {
+            emit_object_added();
+        }
     }
 
     /** @brief Property SET Override function
@@ -63,16 +85,37 @@ class Group : public GroupInherit
      */
     bool asserted(bool value) override;
 
+    /** @brief Get the path of the group instance */
+    const std::string& getPath() const
+    {
+        return path;
+    }
+
   private:
+    /** @brief Set the asserted property of the base class, the signal is
+     *         deferred to the object manager when there is one
+     *
+     *  @param[in]  value   -  True or False
+     *  @return             -  The value set
+     */
+    bool setAsserted(bool value);
+
     /** @brief Path of the group instance */
     std::string path;
 
     /** @brief Reference to Manager object */
     Manager& manager;
 
+    /** @brief Handle of the group in Manager, not set for the groups which
+     *         are not in the layout */
+    std::optional<GroupHandle> handle;
+
     /** @brief The serialize class for storing and restoring groups of LEDs */
     std::shared_ptr<Serialize> serializePtr;
 
+    /** @brief The cached reply of the object manager of the groups */
+    std::shared_ptr<ManagedObjects> objectsPtr;
+
     /** @brief Custom callback when LED group is asserted
      * Callback that holds LED group method which handles lamp test request.
      *
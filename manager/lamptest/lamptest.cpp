@@ -5,6 +5,10 @@
 #include <xyz/openbmc_project/Led/Physical/common.hpp>
 
 #include <algorithm>
+#include <cctype>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
 
 using LedPhysical = sdbusplus::common::xyz::openbmc_project::led::Physical;
 using LedGroup = sdbusplus::common::xyz::openbmc_project::led::Group;
@@ -15,54 +19,84 @@ namespace led
 {
 
 using Json = nlohmann::json;
-static const fs::path lampTestIndicator =
+static constexpr auto lampTestIndicator =
     "/var/lib/phosphor-led-manager/lamp-test-running";
 
-bool LampTest::processLEDUpdates(const ActionSet& ledsAssert,
-                                 const ActionSet& ledsDeAssert)
+void LampTest::driveForcedLEDs(const ActionSet& ledsAssert,
+                               const ActionSet& ledsDeAssert)
 {
-    // If the physical LED status is updated during the lamp test, it should be
-    // saved to Queue, and the queue will be processed after the lamp test is
-    // stopped.
-    if (isLampTestRunning)
+    // Physical LEDs will be updated during lamp test
+    for (const auto& it : ledsDeAssert)
     {
-        // Physical LEDs will be updated during lamp test
-        for (const auto& it : ledsDeAssert)
+        std::string path = std::string(phyLedPath) + it.name;
+        if (forceUpdateLEDs.contains(path))
         {
-            std::string path = std::string(phyLedPath) + it.name;
-            auto iter = std::find_if(
-                forceUpdateLEDs.begin(), forceUpdateLEDs.end(),
-                [&path](const auto& name) { return name == path; });
-
-            if (iter != forceUpdateLEDs.end())
-            {
-                manager.drivePhysicalLED(path, Layout::Action::Off, it.dutyOn,
-                                         it.period);
-            }
+            manager.drivePhysicalLED(path, Layout::Action::Off, it.dutyOn,
+                                     it.period);
         }
+    }
 
-        for (const auto& it : ledsAssert)
+    for (const auto& it : ledsAssert)
+    {
+        std::string path = std::string(phyLedPath) + it.name;
+        if (forceUpdateLEDs.contains(path))
         {
-            std::string path = std::string(phyLedPath) + it.name;
-            auto iter = std::find_if(
-                forceUpdateLEDs.begin(), forceUpdateLEDs.end(),
-                [&path](const auto& name) { return name == path; });
+            manager.drivePhysicalLED(path, it.action, it.dutyOn, it.period);
+        }
+    }
+}
+
+bool LampTest::processLEDUpdates(ActionSet& ledsAssert,
+                                 ActionSet& ledsDeAssert)
+{
+    // If the physical LED status is updated during the lamp test, it should be
+    // saved to Queue, and the queue will be processed after the lamp test is
+    // stopped. Same while the LEDs left on by a previous boot are cleared.
+    if (!isLampTestRunning && !clearing)
+    {
+        return false;
+    }
 
-            if (iter != forceUpdateLEDs.end())
+    if (!scope)
+    {
+        driveForcedLEDs(ledsAssert, ledsDeAssert);
+        updatedLEDsDuringLampTest.emplace(ledsAssert, ledsDeAssert);
+        return true;
+    }
+
+    // Only the LEDs in scope are held back, the others are updated normally.
+    auto extractScoped = [this](ActionSet& leds) {
+        ActionSet scoped{};
+        for (auto it = leds.begin(); it != leds.end();)
+        {
+            if (scope->leds.contains(std::string(phyLedPath) + it->name))
+            {
+                scoped.insert(leds.extract(it++));
+            }
+            else
             {
-                manager.drivePhysicalLED(path, it.action, it.dutyOn, it.period);
+                ++it;
             }
         }
+        return scoped;
+    };
 
-        updatedLEDsDuringLampTest.emplace(ledsAssert, ledsDeAssert);
-        return true;
+    auto scopedAssert = extractScoped(ledsAssert);
+    auto scopedDeAssert = extractScoped(ledsDeAssert);
+
+    if (!scopedAssert.empty() || !scopedDeAssert.empty())
+    {
+        driveForcedLEDs(scopedAssert, scopedDeAssert);
+        updatedLEDsDuringLampTest.emplace(std::move(scopedAssert),
+                                          std::move(scopedDeAssert));
     }
+
     return false;
 }
 
 void LampTest::stop()
 {
-    if (!isLampTestRunning)
+    if (!isLampTestRunning || stopping)
     {
         return;
     }
@@ -70,35 +104,39 @@ void LampTest::stop()
     timer.setEnabled(false);
 
     // Stop host lamp test
-    doHostLampTest(false);
-
-    // Set all the Physical action to Off
-    for (const auto& path : physicalLEDPaths)
+    if (!scope)
     {
-        auto iter =
-            std::find_if(skipUpdateLEDs.begin(), skipUpdateLEDs.end(),
-                         [&path](const auto& skip) { return skip == path; });
-
-        if (iter != skipUpdateLEDs.end())
-        {
-            // Skip update physical path
-            continue;
-        }
-
-        manager.drivePhysicalLED(path, Layout::Action::Off, 0, 0);
+        doHostLampTest(false);
     }
 
-    if (std::filesystem::exists(lampTestIndicator))
+    setIndicator(false);
+
+    if (!statesCaptured)
     {
-        if (!std::filesystem::remove(lampTestIndicator))
-        {
-            lg2::error(
-                "Error removing lamp test on indicator file after lamp test execution.");
-        }
+        // The LEDs were not driven yet, drop the lookup and the reads.
+        planLookup.reset();
+        writesDone = nullptr;
+        finishWrites();
+        setRunning(false);
+        replayHeldUpdates();
+        return;
     }
 
-    isLampTestRunning = false;
-    restorePhysicalLedStates();
+    // Restore the states prior to the lamp test with the same pacing as the
+    // lamp test, with the updates held meanwhile applied. LED updates keep
+    // being held until the LEDs are restored.
+    stopping = true;
+    drivePhysicalLEDs(std::exchange(physicalLEDStatesPriorToLampTest, {}),
+                      [this]() {
+                          stopping = false;
+                          setRunning(false);
+                          replayHeldUpdates();
+
+                          if (std::exchange(startRequested, false))
+                          {
+                              start();
+                          }
+                      });
 }
 
 Layout::Action LampTest::getActionFromString(const std::string& str)
@@ -119,130 +157,449 @@ Layout::Action LampTest::getActionFromString(const std::string& str)
 
 void LampTest::storePhysicalLEDsStates()
 {
+    // Read the states of all the LEDs concurrently, then drive them on.
+    finishWrites();
     physicalLEDStatesPriorToLampTest.clear();
 
-    for (const auto& path : physicalLEDPaths)
-    {
-        auto iter = std::find_if(
-            skipUpdateLEDs.begin(), skipUpdateLEDs.end(),
-            [&path](const auto& skipLed) { return skipLed == path; });
+    readingStates = true;
+    writesDone = [this]() {
+        statesCaptured = true;
 
-        if (iter != skipUpdateLEDs.end())
-        {
-            // Physical LEDs will be skipped
-            continue;
-        }
+        // Set all the Physical action to On for lamp test
+        drivePhysicalLEDs(Layout::Action::On);
+    };
 
-        // Reverse intercept path, Get the name of each member of physical led
-        // e.g: path = /xyz/openbmc_project/led/physical/front_fan
-        //      name = front_fan
-        sdbusplus::object_path object_path(path);
-        auto name = object_path.filename();
-        if (name.empty())
+    for (size_t index = 0; index < physicalLEDs.size(); ++index)
+    {
+        if (!physicalLEDs[index].skipUpdate)
         {
-            lg2::error(
-                "Failed to get the name of member of physical LED path, PATH = {PATH}, NAME = {NAME}",
-                "PATH", path, "NAME", name);
-            continue;
+            queuedWrites.push_back({index, Layout::Action::Off, 0, 0});
         }
+    }
+
+    startWrites();
+}
+
+void LampTest::readCompleted(size_t index, sdbusplus::message_t& reply)
+{
+    const auto& led = physicalLEDs[index];
 
-        std::string state{};
-        uint16_t period{};
-        uint8_t dutyOn{};
+    if (!reply.is_method_error())
+    {
         try
         {
-            auto properties =
-                phosphor::led::utils::DBusHandler::getAllProperties(
-                    path, LedPhysical::interface);
+            phosphor::led::utils::PropertyMap properties;
+            reply.read(properties);
 
-            state = std::get<std::string>(properties["State"]);
-            period = std::get<uint16_t>(properties["Period"]);
-            dutyOn = std::get<uint8_t>(properties["DutyOn"]);
+            auto action = getActionFromString(
+                std::get<std::string>(properties.at("State")));
+            if (action != Layout::Action::Off)
+            {
+                physicalLEDStatesPriorToLampTest.insert_or_assign(
+                    led.name,
+                    Layout::LedAction{
+                        led.name, action,
+                        std::get<uint8_t>(properties.at("DutyOn")),
+                        std::get<uint16_t>(properties.at("Period")),
+                        Layout::Action::On});
+            }
         }
-        catch (const sdbusplus::exception_t& e)
+        catch (const std::exception& e)
         {
             lg2::error(
                 "Failed to get All properties, ERROR = {ERROR}, PATH = {PATH}",
-                "ERROR", e, "PATH", path);
-            continue;
-        }
-
-        phosphor::led::Layout::Action action = getActionFromString(state);
-        if (action != phosphor::led::Layout::Action::Off)
-        {
-            phosphor::led::Layout::LedAction ledAction{
-                name, action, dutyOn, period,
-                phosphor::led::Layout::Action::On};
-            physicalLEDStatesPriorToLampTest.emplace(ledAction);
+                "ERROR", e, "PATH", led.path);
         }
     }
+
+    writeCompleted(index, reply);
 }
 
-void LampTest::start()
+bool LampTest::start()
 {
+    // The lamp test starts once the LEDs left on by a previous boot are
+    // cleared, so that their states are not stored as the states prior to
+    // the lamp test.
+    // Same once a stop restored the LEDs, so that the states are restored
+    // before they are stored again.
+    if (clearing || stopping)
+    {
+        startRequested = true;
+        return true;
+    }
+
     if (isLampTestRunning)
     {
         // reset the timer and then return
         timer.restart(std::chrono::seconds(LAMP_TEST_TIMEOUT_IN_SECS));
 
         // Notify host to reset the timer
-        doHostLampTest(true);
+        if (!scope)
+        {
+            doHostLampTest(true);
+        }
 
-        return;
+        return true;
     }
 
-    // Get paths of all the Physical LED objects
+    if (runningLampTests != 0)
+    {
+        lg2::info("Another lamp test is running, cannot start the lamp test.");
+        return false;
+    }
+
+    // Get the physical LED objects and their services on each start, without
+    // blocking, so the LEDs added since the last lamp test are tested too. A
+    // failed lookup ends the lamp test.
     try
     {
-        physicalLEDPaths = phosphor::led::utils::DBusHandler::getSubTreePaths(
-            phyLedPath, LedPhysical::interface);
+        planLookup = phosphor::led::utils::DBusHandler::getSubTreeAsync(
+            phyLedPath, LedPhysical::interface,
+            [this](const phosphor::led::utils::SubTree& subTree) {
+                loadLampTestPlan(subTree);
+                if (planStale)
+                {
+                    lg2::error(
+                        "Failed to look the physical LEDs up, the lamp test ends.");
+                    timer.restartOnce(std::chrono::seconds(0));
+                    return;
+                }
+                storePhysicalLEDsStates();
+            });
     }
     catch (const sdbusplus::exception_t& e)
     {
         lg2::error(
-            "Failed to call the SubTreePaths method: {ERROR}, ledPath: {PATH}, ledInterface: {INTERFACE}",
+            "Failed to call the SubTree method: {ERROR}, ledPath: {PATH}, ledInterface: {INTERFACE}",
             "ERROR", e, "PATH", phyLedPath, "INTERFACE",
             LedPhysical::interface);
-        return;
+        return false;
     }
 
-    // Get physical LEDs states before lamp test
-    storePhysicalLEDsStates();
-
     // restart lamp test, it contains initiate or reset the timer.
     timer.restart(std::chrono::seconds(LAMP_TEST_TIMEOUT_IN_SECS));
-    isLampTestRunning = true;
+    setRunning(true);
 
     // Notify host to start the lamp test
-    doHostLampTest(true);
+    if (!scope)
+    {
+        doHostLampTest(true);
+    }
 
     // Create a file to maintain the state across reboots that Lamp test is on.
     // This is required as there was a scenario where it has been found that
     // LEDs remains in "on" state if lamp test is triggered and reboot takes
     // place.
-    const auto ledDirectory = lampTestIndicator.parent_path();
+    setIndicator(true);
+
+    // Get physical LEDs states before lamp test once the LEDs are looked up,
+    // the LEDs are driven on once the states are stored.
+    statesCaptured = false;
 
-    if (!fs::exists(ledDirectory))
+    return true;
+}
+
+void LampTest::setRunning(bool running)
+{
+    if (running != isLampTestRunning)
     {
-        fs::create_directories(ledDirectory);
+        running ? ++runningLampTests : --runningLampTests;
     }
+    isLampTestRunning = running;
+}
 
-    std::ofstream ofs(lampTestIndicator.c_str());
+void LampTest::loadLampTestPlan(const phosphor::led::utils::SubTree& subTree)
+{
+    physicalLEDs.clear();
+    physicalLEDs.reserve(subTree.size());
 
-    // Set all the Physical action to On for lamp test
-    for (const auto& path : physicalLEDPaths)
+    for (const auto& [path, services] : subTree)
     {
-        auto iter =
-            std::find_if(skipUpdateLEDs.begin(), skipUpdateLEDs.end(),
-                         [&path](const auto& skip) { return skip == path; });
+        if (services.empty() || (scope && !scope->leds.contains(path)))
+        {
+            continue;
+        }
+
+        physicalLEDs.emplace_back(path, sdbusplus::object_path(path).filename(),
+                                  services.begin()->first,
+                                  forceUpdateLEDs.contains(path),
+                                  skipUpdateLEDs.contains(path));
+    }
 
-        if (iter != skipUpdateLEDs.end())
+    // The lookup failed
+    planStale = subTree.empty();
+}
+
+void LampTest::drivePhysicalLEDs(Layout::Action action,
+                                 std::function<void()> done)
+{
+    // Writes of a previous batch are of no interest anymore.
+    finishWrites();
+    writesDone = std::move(done);
+
+    for (size_t index = 0; index < physicalLEDs.size(); ++index)
+    {
+        if (!physicalLEDs[index].skipUpdate)
+        {
+            queuedWrites.push_back({index, action, 0, 0});
+        }
+    }
+
+    startWrites();
+}
+
+void LampTest::drivePhysicalLEDs(std::map<LedName, Layout::LedAction> states,
+                                 std::function<void()> done)
+{
+    // Writes of a previous batch are of no interest anymore.
+    finishWrites();
+    writesDone = std::move(done);
+
+    std::unordered_set<std::string_view> planned;
+    for (const auto& led : physicalLEDs)
+    {
+        if (!led.skipUpdate)
+        {
+            planned.emplace(led.name);
+        }
+    }
+
+    auto extractPlanned = [&planned](ActionSet& leds) {
+        ActionSet extracted{};
+        for (auto it = leds.begin(); it != leds.end();)
+        {
+            if (planned.contains(it->name))
+            {
+                extracted.insert(leds.extract(it++));
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        return extracted;
+    };
+
+    // The held updates of the planned LEDs are applied to their states, the
+    // other updates are kept held
+    std::queue<std::pair<ActionSet, ActionSet>> held;
+    held.swap(updatedLEDsDuringLampTest);
+    while (!held.empty())
+    {
+        auto& [ledsAssert, ledsDeAssert] = held.front();
+        for (const auto& led : extractPlanned(ledsDeAssert))
+        {
+            states.erase(led.name);
+        }
+        for (const auto& led : extractPlanned(ledsAssert))
+        {
+            states.insert_or_assign(led.name, led);
+        }
+        if (!ledsAssert.empty() || !ledsDeAssert.empty())
+        {
+            updatedLEDsDuringLampTest.emplace(std::move(ledsAssert),
+                                              std::move(ledsDeAssert));
+        }
+        held.pop();
+    }
+
+    for (size_t index = 0; index < physicalLEDs.size(); ++index)
+    {
+        const auto& led = physicalLEDs[index];
+        if (led.skipUpdate)
         {
-            // Skip update physical path
             continue;
         }
 
-        manager.drivePhysicalLED(path, Layout::Action::On, 0, 0);
+        auto it = states.find(led.name);
+        if (it == states.end())
+        {
+            queuedWrites.push_back({index, Layout::Action::Off, 0, 0});
+            continue;
+        }
+        queuedWrites.push_back({index, it->second.action, it->second.dutyOn,
+                                it->second.period});
+    }
+
+    startWrites();
+}
+
+void LampTest::startWrites()
+{
+    writtenLEDs = queuedWrites.size();
+    writesIssued = std::chrono::steady_clock::now();
+
+    pendingWrites.reserve(waveSize == 0 ? queuedWrites.size() : waveSize);
+    issueWave();
+}
+
+void LampTest::issueWave()
+{
+    namespace server = sdbusplus::xyz::openbmc_project::Led::server;
+
+    size_t issued = 0;
+    auto it = queuedWrites.begin();
+    while (it != queuedWrites.end() && (waveSize == 0 || issued < waveSize))
+    {
+        const auto write = *it;
+        const auto& led = physicalLEDs[write.index];
+
+        auto& inFlight = controllerWrites[led.service];
+        if (maxWritesPerController != 0 && inFlight >= maxWritesPerController)
+        {
+            // This controller is busy, try the LEDs of other controllers.
+            ++it;
+            continue;
+        }
+
+        it = queuedWrites.erase(it);
+        ++issued;
+
+        if (readingStates)
+        {
+            try
+            {
+                pendingWrites.emplace_back(
+                    phosphor::led::utils::DBusHandler::getAllPropertiesAsync(
+                        led.service, led.path, LedPhysical::interface,
+                        [this, index = write.index](
+                            sdbusplus::message_t& reply) {
+                            readCompleted(index, reply);
+                        }));
+            }
+            catch (const sdbusplus::exception_t& e)
+            {
+                lg2::error(
+                    "Failed to get All properties, ERROR = {ERROR}, PATH = {PATH}",
+                    "ERROR", e, "PATH", led.path);
+                planStale = true;
+                continue;
+            }
+
+            ++inFlight;
+            ++pendingWriteCount;
+            continue;
+        }
+
+        // A blinking LED gets its duty on and period before its state, the
+        // calls to a service are handled in order.
+        std::vector<std::pair<const char*, PropertyValue>> properties;
+        if (write.action == Layout::Action::Blink)
+        {
+            properties.emplace_back(LedPhysical::property_names::duty_on,
+                                    write.dutyOn);
+            properties.emplace_back(LedPhysical::property_names::period,
+                                    write.period);
+        }
+        properties.emplace_back(LedPhysical::property_names::state,
+                                server::convertForMessage(write.action));
+
+        for (const auto& [property, value] : properties)
+        {
+            try
+            {
+                pendingWrites.emplace_back(
+                    phosphor::led::utils::DBusHandler::setPropertyAsync(
+                        led.service, led.path, LedPhysical::interface,
+                        property, value,
+                        [this, index = write.index](
+                            sdbusplus::message_t& reply) {
+                            writeCompleted(index, reply);
+                        }));
+            }
+            catch (const sdbusplus::exception_t& e)
+            {
+                lg2::error(
+                    "Failed to drive physical LED, ERROR = {ERROR}, PATH = {PATH}",
+                    "ERROR", e, "PATH", led.path);
+                planStale = true;
+                break;
+            }
+
+            ++inFlight;
+            ++pendingWriteCount;
+        }
+    }
+
+    if (pendingWriteCount != 0)
+    {
+        return;
+    }
+
+    // None of the writes of this wave could be sent.
+    if (queuedWrites.empty())
+    {
+        finishWrites();
+    }
+    else
+    {
+        waveTimer.restartOnce(waveInterval);
+    }
+}
+
+void LampTest::writeCompleted(size_t index, sdbusplus::message_t& reply)
+{
+    const auto& led = physicalLEDs[index];
+
+    if (reply.is_method_error())
+    {
+        if (readingStates)
+        {
+            lg2::error("Failed to get All properties, PATH = {PATH}", "PATH",
+                       led.path);
+        }
+        else
+        {
+            lg2::error("Failed to drive physical LED, PATH = {PATH}", "PATH",
+                       led.path);
+        }
+
+        // The LED may have gone away.
+        planStale = true;
+    }
+
+    --controllerWrites[led.service];
+
+    if (--pendingWriteCount != 0)
+    {
+        return;
+    }
+
+    if (!queuedWrites.empty())
+    {
+        // The wave is drained, schedule the next one.
+        waveTimer.restartOnce(waveInterval);
+        return;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - writesIssued);
+    if (readingStates)
+    {
+        lg2::info("Lamp test read {COUNT} physical LEDs in {DURATION_MS} ms",
+                  "COUNT", writtenLEDs, "DURATION_MS", elapsed.count());
+    }
+    else
+    {
+        lg2::info("Lamp test drove {COUNT} physical LEDs in {DURATION_MS} ms",
+                  "COUNT", writtenLEDs, "DURATION_MS", elapsed.count());
+    }
+
+    finishWrites();
+}
+
+void LampTest::finishWrites()
+{
+    waveTimer.setEnabled(false);
+    queuedWrites.clear();
+    controllerWrites.clear();
+    pendingWrites.clear();
+    pendingWriteCount = 0;
+    readingStates = false;
+
+    if (writesDone)
+    {
+        std::exchange(writesDone, nullptr)();
     }
 }
 
@@ -267,10 +624,9 @@ bool LampTest::requestHandler(Group* group, bool value)
 
     if (value)
     {
-        start();
-
-        // Return true in both cases (F -> T && T -> T)
-        return true;
+        // Return true in both cases (F -> T && T -> T), unless another lamp
+        // test is running
+        return start();
     }
     else
     {
@@ -295,14 +651,8 @@ bool LampTest::requestHandler(Group* group, bool value)
     }
 }
 
-void LampTest::restorePhysicalLedStates()
+void LampTest::replayHeldUpdates()
 {
-    // restore physical LEDs states before lamp test
-    ActionSet ledsDeAssert{};
-    manager.driveLEDs(physicalLEDStatesPriorToLampTest, ledsDeAssert);
-    physicalLEDStatesPriorToLampTest.clear();
-
-    // restore physical LEDs states during lamp test
     while (!updatedLEDsDuringLampTest.empty())
     {
         auto& [ledsAssert, ledsDeAssert] = updatedLEDsDuringLampTest.front();
@@ -313,12 +663,55 @@ void LampTest::restorePhysicalLedStates()
 
 void LampTest::doHostLampTest(bool value)
 {
+    if (!hostLampTestService.empty())
+    {
+        setHostLampTest(value);
+        return;
+    }
+
+    // Look the service up without blocking, the lamp test request returns
+    // right away.
     try
     {
-        PropertyValue assertedValue{value};
-        phosphor::led::utils::DBusHandler::setProperty(
+        hostLampTestCall = phosphor::led::utils::DBusHandler::getServiceAsync(
             HOST_LAMP_TEST_OBJECT, LedGroup::interface,
-            LedGroup::property_names::asserted, assertedValue);
+            [this, value](const std::string& service) {
+                hostLampTestService = service;
+                setHostLampTest(value);
+            });
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error(
+            "Failed to get the service, ERROR = {ERROR}, PATH = {PATH}",
+            "ERROR", e, "PATH", std::string(HOST_LAMP_TEST_OBJECT));
+    }
+}
+
+void LampTest::setHostLampTest(bool value)
+{
+    try
+    {
+        PropertyValue assertedValue{value};
+        hostLampTestCall = phosphor::led::utils::DBusHandler::setPropertyAsync(
+            hostLampTestService, HOST_LAMP_TEST_OBJECT, LedGroup::interface,
+            LedGroup::property_names::asserted, assertedValue,
+            [this, value](sdbusplus::message_t& reply) {
+                if (reply.is_method_error())
+                {
+                    lg2::error(
+                        "Failed to set Asserted property, PATH = {PATH}",
+                        "PATH", std::string(HOST_LAMP_TEST_OBJECT));
+
+                    // The host lamp test may be hosted by another service
+                    // next time.
+                    hostLampTestService.clear();
+                    return;
+                }
+
+                lg2::info("Host lamp test notified, ASSERTED = {ASSERTED}",
+                          "ASSERTED", value);
+            });
     }
     catch (const sdbusplus::exception_t& e)
     {
@@ -345,12 +738,23 @@ void LampTest::getPhysicalLEDNamesFromJson(const fs::path& path)
         // define the default JSON as empty
         const std::vector<std::string> empty{};
         auto forceLEDs = json.value("forceLEDs", empty);
-        std::ranges::transform(forceLEDs, std::back_inserter(forceUpdateLEDs),
+        std::ranges::transform(forceLEDs,
+                               std::inserter(forceUpdateLEDs,
+                                             forceUpdateLEDs.begin()),
                                [](const auto& i) { return phyLedPath + i; });
 
         auto skipLEDs = json.value("skipLEDs", empty);
-        std::ranges::transform(skipLEDs, std::back_inserter(skipUpdateLEDs),
+        std::ranges::transform(skipLEDs,
+                               std::inserter(skipUpdateLEDs,
+                                             skipUpdateLEDs.begin()),
                                [](const auto& i) { return phyLedPath + i; });
+
+        // Pace the writes of large systems, by default all the LEDs are
+        // written at once.
+        waveSize = json.value("waveSize", 0);
+        maxWritesPerController = json.value("maxWritesPerController", 0);
+        waveInterval =
+            std::chrono::milliseconds(json.value("waveIntervalMs", 0));
     }
     catch (const std::exception& e)
     {
@@ -363,26 +767,177 @@ void LampTest::getPhysicalLEDNamesFromJson(const fs::path& path)
 
 void LampTest::clearLamps()
 {
-    if (std::filesystem::exists(lampTestIndicator))
+    if (!std::filesystem::exists(indicatorPath))
     {
-        // we need to off all the LEDs.
-        std::vector<std::string> physicalLedPaths =
-            phosphor::led::utils::DBusHandler::getSubTreePaths(
-                phosphor::led::phyLedPath, LedPhysical::interface);
+        return;
+    }
+
+    // we need to clear all the LEDs, without delaying the startup. The
+    // groups are created and restored meanwhile, their LED updates are held
+    // and the LEDs get the states computed by the manager.
+    lg2::info("Clearing the LEDs left on by a previous lamp test");
+    clearing = true;
+
+    try
+    {
+        planLookup = phosphor::led::utils::DBusHandler::getSubTreeAsync(
+            phyLedPath, LedPhysical::interface,
+            [this](const phosphor::led::utils::SubTree& subTree) {
+                loadLampTestPlan(subTree);
+                drivePhysicalLEDs(manager.getLedStates(),
+                                  [this]() { clearDone(); });
+            });
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error(
+            "Failed to call the SubTree method: {ERROR}, ledPath: {PATH}, ledInterface: {INTERFACE}",
+            "ERROR", e, "PATH", phyLedPath, "INTERFACE",
+            LedPhysical::interface);
+        clearDone();
+    }
+}
+
+void LampTest::clearDone()
+{
+    clearing = false;
+
+    // The indicator file is kept when some LEDs could not be cleared, they
+    // are cleared again on the next boot.
+    if (!planStale)
+    {
+        setIndicator(false);
+        lg2::info("Cleared the LEDs left on by a previous lamp test");
+    }
+
+    replayHeldUpdates();
 
-        for (const auto& path : physicalLedPaths)
+    if (std::exchange(startRequested, false))
+    {
+        start();
+    }
+}
+
+void LampTest::setIndicator(bool running)
+{
+    indicatorRunning = running;
+    indicatorUpdate.set_enabled(sdeventplus::source::Enabled::OneShot);
+}
+
+void LampTest::updateIndicator()
+{
+    std::error_code ec;
+
+    if (indicatorRunning)
+    {
+        fs::create_directories(indicatorPath.parent_path(), ec);
+        std::ofstream ofs(indicatorPath.c_str());
+        if (!ofs)
         {
-            manager.drivePhysicalLED(path, phosphor::led::Layout::Action::Off,
-                                     0, 0);
+            lg2::error("Error creating lamp test on indicator file.");
         }
+        return;
+    }
+
+    if (fs::exists(indicatorPath, ec) && !fs::remove(indicatorPath, ec))
+    {
+        lg2::error(
+            "Error removing lamp test on indicator file after lamp test execution.");
+    }
+}
+fs::path LampTest::getIndicatorPath(const std::optional<LampTestScope>& scope)
+{
+    if (!scope)
+    {
+        return lampTestIndicator;
+    }
+
+    return std::string(lampTestIndicator) + "-" + scope->name;
+}
+
+std::vector<LampTestScope> LampTest::getScopesFromJson(const fs::path& path,
+                                                       const GroupMap& ledMap)
+{
+    std::vector<LampTestScope> scopes;
+
+    if (!fs::exists(path) || fs::is_empty(path))
+    {
+        return scopes;
+    }
 
-        // Also remove the lamp test on indicator file.
-        if (!std::filesystem::remove(lampTestIndicator))
+    // The name is part of the lamp test group path and of the indicator
+    // file name
+    auto validName = [](const std::string& name) {
+        return !name.empty() && std::ranges::all_of(name, [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+        });
+    };
+
+    try
+    {
+        std::ifstream jsonFile(path);
+        auto json = Json::parse(jsonFile);
+
+        // define the default JSON as empty
+        const Json empty{};
+        const std::vector<std::string> emptyNames{};
+
+        for (const auto& entry : json.value("scopes", empty))
         {
-            lg2::error(
-                "Error removing lamp test on indicator file after lamp test execution.");
+            LampTestScope scope{entry.value("name", ""), {}};
+            if (!validName(scope.name))
+            {
+                lg2::error(
+                    "Invalid lamp test scope name, SCOPE = {SCOPE}, FILE_PATH = {PATH}",
+                    "SCOPE", scope.name, "PATH", path);
+                continue;
+            }
+            if (std::ranges::find(scopes, scope.name, &LampTestScope::name) !=
+                scopes.end())
+            {
+                lg2::error(
+                    "Duplicate lamp test scope, SCOPE = {SCOPE}, FILE_PATH = {PATH}",
+                    "SCOPE", scope.name, "PATH", path);
+                continue;
+            }
+
+            for (const auto& led : entry.value("leds", emptyNames))
+            {
+                scope.leds.emplace(phyLedPath + led);
+            }
+
+            for (const auto& group : entry.value("groups", emptyNames))
+            {
+                auto it = ledMap.find("/xyz/openbmc_project/led/groups/" +
+                                      group);
+                if (it == ledMap.end())
+                {
+                    lg2::error(
+                        "Unknown LED group in lamp test scope, SCOPE = {SCOPE}, GROUP = {GROUP}",
+                        "SCOPE", scope.name, "GROUP", group);
+                    continue;
+                }
+
+                for (const auto& action : it->second.actionSet)
+                {
+                    scope.leds.emplace(phyLedPath + action.name);
+                }
+            }
+
+            scopes.emplace_back(std::move(scope));
         }
     }
+    catch (const std::exception& e)
+    {
+        lg2::error(
+            "Failed to parse config file, ERROR = {ERROR}, FILE_PATH = {PATH}",
+            "ERROR", e, "PATH", path);
+
+        // No scope rather than the scopes parsed before the error
+        scopes.clear();
+    }
+
+    return scopes;
 }
 } // namespace led
 } // namespace phosphor
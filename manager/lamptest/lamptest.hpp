@@ -6,9 +6,16 @@
 #include "manager.hpp"
 
 #include <nlohmann/json.hpp>
+#include <sdeventplus/source/event.hpp>
 #include <sdeventplus/utility/timer.hpp>
 
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <optional>
 #include <queue>
+#include <unordered_set>
 #include <vector>
 
 namespace phosphor
@@ -16,6 +23,16 @@ namespace phosphor
 namespace led
 {
 
+/** @brief The LEDs covered by a scoped lamp test */
+struct LampTestScope
+{
+    /** @brief Name of the scope, the lamp test group is lamp_test_<name> */
+    std::string name;
+
+    /** @brief Paths of the physical LEDs in the scope */
+    std::unordered_set<std::string> leds;
+};
+
 /** @class LampTest
  *  @brief Manager LampTest feature
  */
@@ -36,13 +53,22 @@ class LampTest
      *
      * @param[in] event   - sd event handler
      * @param[in] manager - reference to manager instance
+     * @param[in] scope   - LEDs covered by the lamp test, all the physical LEDs
+     *                      when not set
      */
-    LampTest(const sdeventplus::Event& event, Manager& manager) :
+    LampTest(const sdeventplus::Event& event, Manager& manager,
+             std::optional<LampTestScope> scope = std::nullopt) :
         timer(event, [this](auto&) { timeOutHandler(); }), manager(manager),
-        groupObj(nullptr)
+        groupObj(nullptr), scope(std::move(scope)),
+        indicatorPath(getIndicatorPath(this->scope)),
+        waveTimer(event, [this](auto&) { issueWave(); }),
+        indicatorUpdate(event, [this](auto&) { updateIndicator(); })
     {
-        // Get the force update and/or skipped physical LEDs names from the
-        // lamp-test-led-overrides.json file during lamp
+        indicatorUpdate.set_enabled(sdeventplus::source::Enabled::Off);
+
+        // Get the force update and/or skipped physical LEDs names and the
+        // pacing of the writes from the lamp-test-led-overrides.json file
+        // during lamp
         getPhysicalLEDNamesFromJson(LAMP_TEST_LED_OVERRIDES_JSON);
     }
 
@@ -64,20 +90,52 @@ class LampTest
     /** @brief Update physical LEDs states during lamp test and the lamp test is
      *         running
      *
-     *  @param[in]  ledsAssert    -  LEDs that are to be asserted newly or to a
-     *                               different state
-     *  @param[in]  ledsDeAssert  -  LEDs that are to be Deasserted
+     *  The updates of the LEDs in the scope of a scoped lamp test are taken
+     *  out of the sets, the other LEDs keep being updated normally.
+     *
+     *  @param[in,out]  ledsAssert    -  LEDs that are to be asserted newly or
+     *                                   to a different state
+     *  @param[in,out]  ledsDeAssert  -  LEDs that are to be Deasserted
+     *
+     *  @return Whether all the updates are handled by the lamp test
+     */
+    bool processLEDUpdates(ActionSet& ledsAssert, ActionSet& ledsDeAssert);
+
+    /** @brief Get the name of the scope of a scoped lamp test
+     *
+     *  @return The scope name, not set when the lamp test covers all the LEDs
+     */
+    std::optional<std::string> getScopeName() const
+    {
+        if (!scope)
+        {
+            return std::nullopt;
+        }
+        return scope->name;
+    }
+
+    /** @brief Get the scoped lamp tests from lamp test JSON config file
+     *
+     *  Each scope lists physical LEDs by name and/or LED groups by name,
+     *  the LEDs of the groups are part of the scope. The scopes whose name
+     *  is not made of letters, digits and underscores, or is a duplicate,
+     *  are skipped. No scope is returned when the file cannot be parsed.
+     *
+     *  @param[in]  path    - path of LED JSON file
+     *  @param[in]  ledMap  - LEDs group layout
      *
-     *  @return Is running lamp test, true running
+     *  @return The lamp test scopes
      */
-    bool processLEDUpdates(const ActionSet& ledsAssert,
-                           const ActionSet& ledsDeAssert);
+    static std::vector<LampTestScope> getScopesFromJson(const fs::path& path,
+                                                        const GroupMap& ledMap);
 
     /** @brief Clear LEDs triggered by lamptest
      * When system reboots during lamptest, leds triggered by lamptest needs to
-     * be cleared in the upcoming boot. This method clears all the leds along
-     * with the persisted lamp test indicator file so that there is no sign of
-     * lamptest.
+     * be cleared in the upcoming boot. This method drives all the leds to the
+     * states computed by the manager and removes the persisted lamp test
+     * indicator file so that there is no sign of lamptest. The LEDs are
+     * looked up and cleared from the event loop, so the startup is not
+     * delayed, the LED updates are held until then.
      */
     void clearLamps();
 
@@ -91,8 +149,107 @@ class LampTest
     /** @brief Pointer to Group object */
     Group* groupObj;
 
-    /** all the Physical paths */
-    std::vector<std::string> physicalLEDPaths;
+    /** @brief LEDs covered by a scoped lamp test */
+    std::optional<LampTestScope> scope;
+
+    /** @brief Path of the file indicating the lamp test is running */
+    fs::path indicatorPath;
+
+    /** @brief Physical LED as driven by the lamp test */
+    struct PhysicalLED
+    {
+        /** @brief D-Bus object path of the physical LED */
+        std::string path;
+
+        /** @brief Name of the physical LED, the last element of the path */
+        std::string name;
+
+        /** @brief D-Bus service hosting the physical LED */
+        std::string service;
+
+        /** @brief Changes are forcibly updated even during lamp test */
+        bool forceUpdate;
+
+        /** @brief The LED is exempted from lamp test */
+        bool skipUpdate;
+    };
+
+    /** @brief The lamp test plan, all the physical LEDs with their service
+     *         and override flags */
+    std::vector<PhysicalLED> physicalLEDs;
+
+    /** @brief A write of a physical LED */
+    struct PhysicalWrite
+    {
+        /** @brief Index of the LED in the lamp test plan */
+        size_t index;
+
+        /** @brief Action applied to the LED */
+        Layout::Action action;
+
+        /** @brief Duty on of the LED, written when it blinks */
+        uint8_t dutyOn;
+
+        /** @brief Period of the LED, written when it blinks */
+        uint16_t period;
+    };
+
+    /** @brief The physical LEDs could not be looked up or driven, the plan
+     *         is looked up again on each start */
+    bool planStale{true};
+
+    /** @brief The queued calls read the physical LED states instead of
+     *         writing them */
+    bool readingStates{false};
+
+    /** @brief Slots of the in-flight physical LED writes */
+    std::vector<sdbusplus::slot_t> pendingWrites;
+
+    /** @brief Number of physical LED writes without a reply */
+    size_t pendingWriteCount{0};
+
+    /** @brief Time the current physical LED writes were issued */
+    std::chrono::steady_clock::time_point writesIssued;
+
+    /** @brief Maximum number of LEDs written per wave, 0 for all at once */
+    size_t waveSize{0};
+
+    /** @brief Maximum number of in-flight writes per LED controller service,
+     *         0 for no limit */
+    size_t maxWritesPerController{0};
+
+    /** @brief Delay between the end of a wave and the start of the next */
+    std::chrono::milliseconds waveInterval{0};
+
+    /** @brief Timer used to schedule the next wave of writes */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> waveTimer;
+
+    /** @brief The writes of the LEDs yet to be written */
+    std::deque<PhysicalWrite> queuedWrites;
+
+    /** @brief Number of LEDs written by the current writes */
+    size_t writtenLEDs{0};
+
+    /** @brief Number of in-flight writes per LED controller service */
+    std::unordered_map<std::string, size_t> controllerWrites;
+
+    /** @brief Called once all the current writes are done */
+    std::function<void()> writesDone;
+
+    /** @brief Service hosting the host lamp test object */
+    std::string hostLampTestService;
+
+    /** @brief Slot of the pending host lamp test call */
+    std::optional<sdbusplus::slot_t> hostLampTestCall;
+
+    /** @brief Slot of the pending lookup of the LEDs to be cleared */
+    std::optional<sdbusplus::slot_t> planLookup;
+
+    /** @brief Requested state of the lamp test indicator file */
+    bool indicatorRunning{false};
+
+    /** @brief Event used to update the lamp test indicator file */
+    sdeventplus::source::Defer indicatorUpdate;
 
     /** @brief Queue to save LED states during lamp test */
     std::queue<std::pair<ActionSet, ActionSet>> updatedLEDsDuringLampTest;
@@ -100,34 +257,148 @@ class LampTest
     /** @brief Get state of the lamp test operation */
     bool isLampTestRunning{false};
 
-    /** @brief Physical LED states prior to lamp test */
-    ActionSet physicalLEDStatesPriorToLampTest;
+    /** @brief The LEDs left on by a previous boot are being cleared */
+    bool clearing{false};
+
+    /** @brief A lamp test was requested while clearing or stopping, it
+     *         starts once the LEDs are cleared or restored */
+    bool startRequested{false};
+
+    /** @brief The physical LED states prior to lamp test are stored */
+    bool statesCaptured{false};
+
+    /** @brief The physical LEDs are being restored after the lamp test */
+    bool stopping{false};
+
+    /** @brief Physical LED states prior to lamp test, the LEDs which are off
+     *         are not stored */
+    std::map<LedName, Layout::LedAction> physicalLEDStatesPriorToLampTest;
 
-    /** @brief Vector of names of physical LEDs, whose changes will be forcibly
-     *         updated even during lamp test. */
-    std::vector<std::string> forceUpdateLEDs;
+    /** @brief Paths of physical LEDs, whose changes will be forcibly updated
+     *         even during lamp test. */
+    std::unordered_set<std::string> forceUpdateLEDs;
 
-    /** @brief Vector of names of physical LEDs, that will be exempted from lamp
-     *         test */
-    std::vector<std::string> skipUpdateLEDs;
+    /** @brief Paths of physical LEDs, that will be exempted from lamp test */
+    std::unordered_set<std::string> skipUpdateLEDs;
+
+    /** @brief Number of lamp tests running, lamp tests of different scopes
+     *         are exclusive */
+    static inline size_t runningLampTests = 0;
 
     /** @brief Start and restart lamp test depending on what is the current
-     *         state. */
-    void start();
+     *         state.
+     *
+     *  The physical LEDs are looked up, their states are read and they are
+     *  driven on from the event loop. The lamp test ends right away when the
+     *  LEDs cannot be looked up.
+     *
+     *  @return false when another lamp test is running or the physical LEDs
+     *          lookup could not be sent
+     */
+    bool start();
+
+    /** @brief Set the running state of the lamp test
+     *
+     *  @param[in]  running  -  Whether the lamp test is running
+     */
+    void setRunning(bool running);
+
+    /** @brief Drive the LEDs which are forcibly updated during lamp test
+     *
+     *  @param[in]  ledsAssert    -  LEDs that are to be asserted
+     *  @param[in]  ledsDeAssert  -  LEDs that are to be Deasserted
+     */
+    void driveForcedLEDs(const ActionSet& ledsAssert,
+                         const ActionSet& ledsDeAssert);
+
+    /** @brief Get the path of the lamp test indicator file
+     *
+     *  @param[in]  scope  -  LEDs covered by a scoped lamp test
+     *
+     *  @return The indicator file path
+     */
+    static fs::path getIndicatorPath(const std::optional<LampTestScope>& scope);
 
-    /** @brief Stop lamp test. */
+    /** @brief Stop lamp test.
+     *
+     *  The physical LEDs are restored to their states prior to lamp test, with
+     *  the same pacing as the lamp test.
+     */
     void stop();
 
     /** @brief This method gets called when the lamp test procedure is done as
      *         part of timeout. */
     void timeOutHandler();
 
-    /** @brief Restore the physical LEDs states after the lamp test finishes */
-    void restorePhysicalLedStates();
-
-    /** @brief Store the physical LEDs states before the lamp test start */
+    /** @brief Store the physical LEDs states before the lamp test start
+     *
+     *  The states are read concurrently with the same pacing as the writes,
+     *  the LEDs are driven on once all the states are read.
+     */
     void storePhysicalLEDsStates();
 
+    /** @brief Handle the reply of a physical LED states read
+     *
+     *  @param[in]  index  -  Index of the LED in the lamp test plan
+     *  @param[in]  reply  -  The reply message
+     */
+    void readCompleted(size_t index, sdbusplus::message_t& reply);
+
+    /** @brief Load the lamp test plan from a mapper sub tree
+     *
+     *  @param[in]  subTree  -  Physical LED paths and their services
+     */
+    void loadLampTestPlan(const phosphor::led::utils::SubTree& subTree);
+
+    /** @brief Drive all the planned physical LEDs concurrently
+     *
+     *  The writes are issued without waiting for the replies, so that all
+     *  the LEDs change within one bus round trip. When a wave size or a per
+     *  controller limit is configured, the writes are issued in waves paced
+     *  by the wave timer instead.
+     *
+     *  @param[in]  action  -  Action to be applied to the physical LEDs
+     *  @param[in]  done    -  Called once all the writes are done
+     */
+    void drivePhysicalLEDs(Layout::Action action,
+                           std::function<void()> done = nullptr);
+
+    /** @brief Drive the planned physical LEDs to states concurrently
+     *
+     *  The LEDs of the plan are written with the same pacing as the lamp
+     *  test. The held updates of these LEDs are applied to the states and
+     *  dropped, the held updates of the other LEDs are kept.
+     *
+     *  @param[in]  states  -  States of the LEDs by name, the LEDs not in the
+     *                         map are off
+     *  @param[in]  done    -  Called once all the writes are done
+     */
+    void drivePhysicalLEDs(std::map<LedName, Layout::LedAction> states,
+                           std::function<void()> done);
+
+    /** @brief Issue the writes of the LEDs queued for the current writes */
+    void startWrites();
+
+    /** @brief Issue the next wave of queued physical LED writes */
+    void issueWave();
+
+    /** @brief Drive the LEDs to the updates held during lamp test */
+    void replayHeldUpdates();
+
+    /** @brief Called once the LEDs left on by a previous boot are cleared */
+    void clearDone();
+
+    /** @brief Handle the reply of a physical LED write
+     *
+     *  @param[in]  index  -  Index of the LED in the lamp test plan
+     *  @param[in]  reply  -  The reply message
+     */
+    void writeCompleted(size_t index, sdbusplus::message_t& reply);
+
+    /** @brief Drop the outstanding writes and run the completion callback of
+     *         the current writes, if any */
+    void finishWrites();
+
     /** @brief Returns action enum based on string
      *
      *  @param[in]  str - Action string
@@ -137,10 +408,29 @@ class LampTest
     static Layout::Action getActionFromString(const std::string& str);
 
     /** @brief Notify host to start / stop the lamp test
+     *
+     *  The host lamp test service is looked up and the property is set
+     *  without blocking, the result is logged.
+     *
+     *  @param[in]  value   -  the Asserted property value
+     */
+    void doHostLampTest(bool value);
+
+    /** @brief Set the Asserted property of the host lamp test object
      *
      *  @param[in]  value   -  the Asserted property value
      */
-    static void doHostLampTest(bool value);
+    void setHostLampTest(bool value);
+
+    /** @brief Request the lamp test indicator file to be created or removed
+     *         from the event loop
+     *
+     *  @param[in]  running  -  Whether the lamp test is running
+     */
+    void setIndicator(bool running);
+
+    /** @brief Create or remove the lamp test indicator file */
+    void updateIndicator();
 
     /** @brief Get physical LED names from lamp test JSON config file
      *
@@ -1,11 +1,15 @@
 #include "config.h"
 
 #include "config-validator.hpp"
+#include "fault-monitor/fru-fault-monitor.hpp"
+#include "fault-monitor/group-updater.hpp"
+#include "fault-monitor/operational-status-monitor.hpp"
 #include "group.hpp"
 #include "json-parser.hpp"
 #include "lamptest/lamptest.hpp"
 #include "ledlayout.hpp"
 #include "manager.hpp"
+#include "query.hpp"
 #include "serialize.hpp"
 #include "utils.hpp"
 
@@ -13,8 +17,11 @@
 #include <sdeventplus/event.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 int main(int argc, char** argv)
 {
@@ -38,10 +45,25 @@ int main(int argc, char** argv)
     /** @brief Group manager object */
     phosphor::led::Manager manager(bus, systemLedMap, event);
 
+    if constexpr (LED_STATE_SNAPSHOT)
+    {
+        /** @brief Publish the LED states to local readers */
+        manager.setSnapshot(std::make_shared<phosphor::led::snapshot::Writer>(
+            LED_STATE_SNAPSHOT_FILE, systemLedMap));
+    }
+
     /** @brief sd_bus object manager */
     sdbusplus::server::manager_t objManager(bus,
                                             "/xyz/openbmc_project/led/groups");
 
+    /** @brief Cached reply of GetManagedObjects and batched signals of the
+     *         groups */
+    auto objectsPtr = std::make_shared<phosphor::led::ManagedObjects>(
+        bus, event, "/xyz/openbmc_project/led/groups");
+
+    /** @brief Bulk queries of the LED states */
+    phosphor::led::Query query(bus, "/xyz/openbmc_project/led/groups", manager);
+
     /** @brief vector of led groups */
     std::vector<std::unique_ptr<phosphor::led::Group>> groups;
 
@@ -53,37 +75,60 @@ int main(int argc, char** argv)
             std::make_shared<phosphor::led::Serialize>(SAVED_GROUPS_FILE);
     }
 
-    std::unique_ptr<phosphor::led::LampTest> lampTest;
+    /** @brief lamp tests, the first one covers all the LEDs and the others
+     *         are scoped to part of the LEDs */
+    std::vector<std::unique_ptr<phosphor::led::LampTest>> lampTests;
 
     if constexpr (USE_LAMP_TEST)
     {
-        lampTest = std::make_unique<phosphor::led::LampTest>(event, manager);
-
-        // Clear leds triggered by lamp test in previous boot
-        lampTest->clearLamps();
-
-        groups.emplace_back(std::make_unique<phosphor::led::Group>(
-            bus, LAMP_TEST_OBJECT, manager, serializePtr,
-            [&lampTest](auto&& arg1, auto&& arg2) {
-                return lampTest->requestHandler(
-                    std::forward<decltype(arg1)>(arg1),
-                    std::forward<decltype(arg2)>(arg2));
-            }));
+        lampTests.emplace_back(
+            std::make_unique<phosphor::led::LampTest>(event, manager));
+
+        for (auto& scope : phosphor::led::LampTest::getScopesFromJson(
+                 LAMP_TEST_LED_OVERRIDES_JSON, systemLedMap))
+        {
+            lampTests.emplace_back(std::make_unique<phosphor::led::LampTest>(
+                event, manager, std::move(scope)));
+        }
+
+        for (auto& lampTest : lampTests)
+        {
+            // Clear leds triggered by lamp test in previous boot
+            lampTest->clearLamps();
+
+            auto objPath = std::string(LAMP_TEST_OBJECT);
+            if (lampTest->getScopeName())
+            {
+                objPath += "_" + *lampTest->getScopeName();
+            }
+
+            groups.emplace_back(std::make_unique<phosphor::led::Group>(
+                bus, objPath, manager, serializePtr, objectsPtr,
+                [lampTest = lampTest.get()](auto&& arg1, auto&& arg2) {
+                    return lampTest->requestHandler(
+                        std::forward<decltype(arg1)>(arg1),
+                        std::forward<decltype(arg2)>(arg2));
+                }));
+        }
 
         // Register a lamp test method in the manager class, and call this
         // method when the lamp test is started
-        manager.setLampTestCallBack([&lampTest](auto&& arg1, auto&& arg2) {
-            return lampTest->processLEDUpdates(
-                std::forward<decltype(arg1)>(arg1),
-                std::forward<decltype(arg2)>(arg2));
-        });
+        manager.setLampTestCallBack(
+            [&lampTests](auto& ledsAssert, auto& ledsDeAssert) {
+                return std::ranges::any_of(lampTests, [&](auto& lampTest) {
+                    return lampTest->processLEDUpdates(ledsAssert,
+                                                       ledsDeAssert);
+                });
+            });
     }
 
     /** Now create so many dbus objects as there are groups */
     std::ranges::transform(systemLedMap, std::back_inserter(groups),
-                           [&bus, &manager, serializePtr](auto& grp) {
+                           [&bus, &manager, serializePtr,
+                            objectsPtr](auto& grp) {
                                return std::make_unique<phosphor::led::Group>(
-                                   bus, grp.first, manager, serializePtr);
+                                   bus, grp.first, manager, serializePtr,
+                                   objectsPtr);
                            });
 
     // Attach the bus to sd_event to service user requests
@@ -91,6 +136,52 @@ int main(int argc, char** argv)
 
     /** @brief Claim the bus */
     bus.request_name("xyz.openbmc_project.LED.GroupManager");
+
+    /** @brief fault monitor sharing the bus and the event loop */
+    std::unordered_map<std::string, phosphor::led::Group*> groupHandles;
+    std::unique_ptr<phosphor::led::GroupUpdater> faultUpdater;
+    std::unique_ptr<phosphor::led::fru::fault::monitor::Add> fruMonitor;
+    std::unique_ptr<phosphor::led::Operational::status::monitor::Monitor>
+        statusMonitor;
+
+    if constexpr (IN_PROCESS_FAULT_MONITOR)
+    {
+        for (const auto& group : groups)
+        {
+            groupHandles.emplace(group->getPath(), group.get());
+        }
+
+        // Set the groups directly instead of over D-Bus
+        faultUpdater = std::make_unique<phosphor::led::GroupUpdater>(
+            bus, event, std::chrono::milliseconds(FAULT_MONITOR_COALESCE_MS),
+            phosphor::led::Dampening{
+                std::chrono::milliseconds(FAULT_MONITOR_MIN_HOLD_MS),
+                FAULT_MONITOR_MAX_TRANSITIONS,
+                std::chrono::milliseconds(FAULT_MONITOR_HALF_LIFE_MS)},
+            [&groupHandles](const std::string& path, bool assert) {
+                auto it = groupHandles.find(path);
+                if (it == groupHandles.end())
+                {
+                    return false;
+                }
+                it->second->asserted(assert);
+                return true;
+            });
+
+        if constexpr (MONITOR_OPERATIONAL_STATUS)
+        {
+            statusMonitor = std::make_unique<
+                phosphor::led::Operational::status::monitor::Monitor>(
+                bus, *faultUpdater);
+        }
+        else
+        {
+            fruMonitor =
+                std::make_unique<phosphor::led::fru::fault::monitor::Add>(
+                    bus, *faultUpdater);
+        }
+    }
+
     event.loop();
 
     return 0;
@@ -0,0 +1,188 @@
+#include "managed-objects.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/exception.hpp>
+#include <xyz/openbmc_project/Led/Group/common.hpp>
+
+#include <variant>
+
+using LedGroup = sdbusplus::common::xyz::openbmc_project::led::Group;
+
+namespace phosphor
+{
+namespace led
+{
+
+static constexpr auto objMgrIntf = "org.freedesktop.DBus.ObjectManager";
+
+/** @brief Create the slot of the callback of a path */
+static sdbusplus::slot_t addObject(sdbusplus::bus_t& bus, const char* path,
+                                   sd_bus_message_handler_t callback,
+                                   void* context)
+{
+    sd_bus_slot* slot = nullptr;
+    int r = sd_bus_add_object(bus.get(), &slot, path, callback, context);
+    if (r < 0)
+    {
+        throw sdbusplus::exception::SdBusError(-r, "sd_bus_add_object");
+    }
+    return sdbusplus::slot_t(slot);
+}
+
+ManagedObjects::ManagedObjects(sdbusplus::bus_t& bus,
+                               const sdeventplus::Event& event,
+                               const std::string& objPath) :
+    bus(bus), path(objPath),
+    flushSource(event, [this](auto&) { flush(); }),
+    slot(addObject(bus, path.c_str(), &ManagedObjects::handler, this))
+{
+    flushSource.set_enabled(sdeventplus::source::Enabled::Off);
+}
+
+void ManagedObjects::add(const std::string& group, bool asserted,
+                         std::function<void()> emitAdded)
+{
+    auto& published = groups.try_emplace(group).first->second;
+    published.asserted = asserted;
+    published.emitAdded = std::move(emitAdded);
+    cached.reset();
+    defer(group);
+}
+
+void ManagedObjects::remove(const std::string& group)
+{
+    groups.erase(group);
+    pending.erase(group);
+    cached.reset();
+}
+
+void ManagedObjects::setAsserted(const std::string& group, bool asserted)
+{
+    auto it = groups.find(group);
+    if (it == groups.end() || it->second.asserted == asserted)
+    {
+        return;
+    }
+    it->second.asserted = asserted;
+    cached.reset();
+    defer(group);
+}
+
+void ManagedObjects::defer(const std::string& group)
+{
+    if (pending.empty())
+    {
+        flushSource.set_enabled(sdeventplus::source::Enabled::OneShot);
+    }
+    pending.insert(group);
+}
+
+void ManagedObjects::flush()
+{
+    for (const auto& group : pending)
+    {
+        auto it = groups.find(group);
+        if (it == groups.end() || !it->second.emitAdded)
+        {
+            continue;
+        }
+
+        // The InterfacesAdded carries the current value
+        auto& published = it->second;
+        if (!published.announced)
+        {
+            published.emitAdded();
+            published.announced = true;
+            published.emitted = published.asserted;
+            continue;
+        }
+
+        if (published.emitted == published.asserted)
+        {
+            continue;
+        }
+        published.emitted = published.asserted;
+
+        int r = sd_bus_emit_properties_changed(
+            bus.get(), group.c_str(), LedGroup::interface,
+            LedGroup::property_names::asserted, nullptr);
+        if (r < 0)
+        {
+            lg2::error(
+                "Failed to emit the Asserted property, ERRNO = {ERRNO}, PATH = {PATH}",
+                "ERRNO", -r, "PATH", group);
+        }
+    }
+    pending.clear();
+}
+
+void ManagedObjects::build()
+{
+    // The standard interfaces are listed with no properties, as sd-bus does
+    using Properties = std::map<std::string, std::variant<bool>>;
+    std::map<sdbusplus::object_path, std::map<std::string, Properties>> objects;
+    for (const auto& [group, published] : groups)
+    {
+        objects.emplace(
+            group,
+            std::map<std::string, Properties>{
+                {"org.freedesktop.DBus.Peer", {}},
+                {"org.freedesktop.DBus.Introspectable", {}},
+                {"org.freedesktop.DBus.Properties", {}},
+                {LedGroup::interface,
+                 {{LedGroup::property_names::asserted,
+                   published.asserted}}}});
+    }
+
+    // The body is held in a sealed message, the replies copy it
+    auto msg = bus.new_signal(path.c_str(), objMgrIntf, "GetManagedObjects");
+    msg.append(objects);
+    int r = sd_bus_message_seal(msg.get(), 1, 0);
+    if (r < 0)
+    {
+        throw sdbusplus::exception::SdBusError(-r, "sd_bus_message_seal");
+    }
+    cached.emplace(std::move(msg));
+}
+
+int ManagedObjects::handler(sd_bus_message* msg, void* context,
+                            sd_bus_error* error)
+{
+    if (sd_bus_message_is_method_call(msg, objMgrIntf, "GetManagedObjects") <=
+        0)
+    {
+        return 0;
+    }
+
+    auto* self = static_cast<ManagedObjects*>(context);
+    try
+    {
+        if (!self->cached)
+        {
+            self->build();
+        }
+
+        auto reply = sdbusplus::message_t(msg).new_method_return();
+        int r = sd_bus_message_rewind(self->cached->get(), 1);
+        if (r >= 0)
+        {
+            r = sd_bus_message_copy(reply.get(), self->cached->get(), 1);
+        }
+        if (r < 0)
+        {
+            throw sdbusplus::exception::SdBusError(-r, "sd_bus_message_copy");
+        }
+        reply.method_return();
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to reply the managed objects, ERROR = {ERROR}",
+                   "ERROR", e);
+        self->cached.reset();
+        return sd_bus_error_set(error, e.name(), e.description());
+    }
+    return 1;
+}
+
+} // namespace led
+} // namespace phosphor
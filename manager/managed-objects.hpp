@@ -0,0 +1,133 @@
+#pragma once
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/message.hpp>
+#include <sdbusplus/slot.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/event.hpp>
+
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_set>
+
+namespace phosphor
+{
+namespace led
+{
+
+/** @class ManagedObjects
+ *  @brief Publish the groups of the object manager
+ *  @details GetManagedObjects is served from a cache: the reply is built once
+ *  and copied into each reply until the Asserted property of a group changes,
+ *  instead of walking and serializing all the group objects on every call.
+ *  The call is intercepted on the path of the object manager before sd-bus
+ *  handles it.
+ *
+ *  The signals of the groups are deferred to the end of the event loop
+ *  iteration: the InterfacesAdded of the groups created at startup are sent
+ *  in one burst, and the changes of the Asserted property of a group during
+ *  an iteration are merged into one PropertiesChanged with the final value,
+ *  none when the value went back.
+ */
+class ManagedObjects
+{
+  public:
+    ManagedObjects() = delete;
+    ~ManagedObjects() = default;
+    ManagedObjects(const ManagedObjects&) = delete;
+    ManagedObjects& operator=(const ManagedObjects&) = delete;
+    ManagedObjects(ManagedObjects&&) = delete;
+    ManagedObjects& operator=(ManagedObjects&&) = delete;
+
+    /** @brief Constructs ManagedObjects
+     *
+     *  @param[in] bus     - Handle to system dbus
+     *  @param[in] event   - sd event handler
+     *  @param[in] objPath - The D-Bus path of the object manager
+     */
+    ManagedObjects(sdbusplus::bus_t& bus, const sdeventplus::Event& event,
+                   const std::string& objPath);
+
+    /** @brief Add a group, its InterfacesAdded is sent with the next batch
+     *
+     *  @param[in] group     - The D-Bus path of the group
+     *  @param[in] asserted  - The Asserted property
+     *  @param[in] emitAdded - Send the InterfacesAdded of the group
+     */
+    void add(const std::string& group, bool asserted,
+             std::function<void()> emitAdded);
+
+    /** @brief Remove a group
+     *
+     *  @param[in] group - The D-Bus path of the group
+     */
+    void remove(const std::string& group);
+
+    /** @brief Update the Asserted property of a group, the cached reply is
+     *         dropped and the PropertiesChanged is deferred when it changes.
+     *         Groups which were not added are ignored.
+     *
+     *  @param[in] group    - The D-Bus path of the group
+     *  @param[in] asserted - The Asserted property
+     */
+    void setAsserted(const std::string& group, bool asserted);
+
+  private:
+    /** @brief Handle to system dbus */
+    sdbusplus::bus_t& bus;
+
+    /** @brief The D-Bus path of the object manager */
+    std::string path;
+
+    /** @brief A published group */
+    struct Published
+    {
+        /** @brief The Asserted property */
+        bool asserted = false;
+
+        /** @brief The Asserted property last sent to the subscribers */
+        bool emitted = false;
+
+        /** @brief Whether the InterfacesAdded was sent */
+        bool announced = false;
+
+        /** @brief Send the InterfacesAdded of the group */
+        std::function<void()> emitAdded;
+    };
+
+    /** @brief The published groups */
+    std::map<std::string, Published> groups;
+
+    /** @brief The groups whose signals are deferred */
+    std::unordered_set<std::string> pending;
+
+    /** @brief Send the deferred signals at the end of the iteration */
+    sdeventplus::source::Defer flushSource;
+
+    /** @brief The body of the reply, not set when a group changed */
+    std::optional<sdbusplus::message_t> cached;
+
+    /** @brief Slot of the callback of the object manager path */
+    sdbusplus::slot_t slot;
+
+    /** @brief Build the body of the reply */
+    void build();
+
+    /** @brief Defer the signals of a group */
+    void defer(const std::string& group);
+
+    /** @brief Send the deferred signals */
+    void flush();
+
+    /** @brief Callback of the method calls on the object manager path
+     *
+     *  @return 0 when the call is left to sd-bus
+     */
+    static int handler(sd_bus_message* msg, void* context,
+                       sd_bus_error* error);
+};
+
+} // namespace led
+} // namespace phosphor
@@ -7,9 +7,13 @@
 #include <xyz/openbmc_project/Led/Physical/server.hpp>
 
 #include <algorithm>
+#include <bit>
 #include <chrono>
 #include <iostream>
+#include <ranges>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 using LedPhysical = sdbusplus::common::xyz::openbmc_project::led::Physical;
 
@@ -44,7 +48,8 @@ static void applyGroupAction(std::map<LedName, Layout::LedAction>& newState,
 
 // create the resulting new map from all currently asserted groups
 static auto getNewMapWithGroupPriorities(
-    std::set<const Layout::GroupLayout*, Layout::CompareGroupLayout> sorted)
+    const std::set<const Layout::GroupLayout*, Layout::CompareGroupLayout>&
+        sorted)
     -> std::map<LedName, Layout::LedAction>
 {
     std::map<LedName, Layout::LedAction> newState;
@@ -62,7 +67,7 @@ static auto getNewMapWithGroupPriorities(
 }
 
 static std::map<LedName, Layout::LedAction> getNewMapWithLEDPriorities(
-    std::set<const Layout::GroupLayout*> assertedGroups)
+    const std::set<const Layout::GroupLayout*>& assertedGroups)
 {
     std::map<LedName, Layout::LedAction> newState;
     // update the new map with the desired state
@@ -79,7 +84,7 @@ static std::map<LedName, Layout::LedAction> getNewMapWithLEDPriorities(
 
 // create the resulting new map from all currently asserted groups
 std::map<LedName, Layout::LedAction> Manager::getNewMap(
-    std::set<const Layout::GroupLayout*> assertedGroups)
+    const std::set<const Layout::GroupLayout*>& assertedGroups)
 {
     std::map<LedName, Layout::LedAction> newState;
 
@@ -109,58 +114,325 @@ std::map<LedName, Layout::LedAction> Manager::getNewMap(
     return newState;
 }
 
-// Assert -or- De-assert
-bool Manager::setGroupState(const std::string& path, bool assert,
-                            ActionSet& ledsAssert, ActionSet& ledsDeAssert)
+static constexpr size_t wordBits = 64;
+
+// Find the highest asserted bit of a row
+static std::optional<size_t> findLastBit(std::span<const RowWord> row,
+                                         const std::vector<uint64_t>& asserted)
 {
-    if (assert)
+    for (const auto& [word, bits] : std::views::reverse(row))
     {
-        assertedGroups.insert(&ledMap.at(path));
+        auto set = bits & asserted[word];
+        if (set != 0)
+        {
+            return (word * wordBits) + (wordBits - 1) - std::countl_zero(set);
+        }
     }
-    else
+    return std::nullopt;
+}
+
+// Find the lowest asserted bit of a row
+static std::optional<size_t> findFirstBit(std::span<const RowWord> row,
+                                          const std::vector<uint64_t>& asserted)
+{
+    for (const auto& [word, bits] : row)
+    {
+        auto set = bits & asserted[word];
+        if (set != 0)
+        {
+            return (word * wordBits) + std::countr_zero(set);
+        }
+    }
+    return std::nullopt;
+}
+
+// Build the sparse rows from the bits set in each row
+static BitRows makeRows(std::vector<std::vector<size_t>>& rowBits)
+{
+    BitRows rows;
+    rows.offsets.push_back(0);
+    for (auto& bits : rowBits)
+    {
+        std::ranges::sort(bits);
+        for (auto bit : bits)
+        {
+            auto word = bit / wordBits;
+            if (rows.words.size() == rows.offsets.back() ||
+                rows.words.back().word != word)
+            {
+                rows.words.push_back({word, 0});
+            }
+            rows.words.back().bits |= uint64_t{1} << (bit % wordBits);
+        }
+        rows.offsets.push_back(rows.words.size());
+    }
+    return rows;
+}
+
+const Layout::LedAction* Manager::findGroupAction(size_t bit,
+                                                  size_t index) const
+{
+    const auto& actions = groupEntries[bitGroups[bit]].actions;
+    return std::ranges::find(actions, index, &GroupAction::index)->action;
+}
+
+template <>
+const Layout::LedAction* Manager::resolveState<PriorityMode::group>(
+    size_t index) const
+{
+    // The bits follow the group priorities, the LED takes the action of the
+    // highest priority asserted group
+    auto bit = findLastBit(memberRows.row(index), assertedRow);
+    if (!bit)
+    {
+        return nullptr;
+    }
+    return findGroupAction(*bit, index);
+}
+
+template <>
+const Layout::LedAction* Manager::resolveState<PriorityMode::led>(
+    size_t index) const
+{
+    // The first asserted group requesting the priority action of the LED
+    // cannot be overridden
+    auto bit = findFirstBit(priorityRows.row(index), assertedRow);
+    if (bit)
+    {
+        return findGroupAction(*bit, index);
+    }
+
+    // otherwise the last asserted group wins
+    bit = findLastBit(memberRows.row(index), assertedRow);
+    if (!bit)
+    {
+        return nullptr;
+    }
+    return findGroupAction(*bit, index);
+}
+
+void Manager::indexGroups()
+{
+    // Index the LEDs in name order
+    std::set<std::string_view> names;
+    for (const auto& [path, group] : ledMap)
+    {
+        for (const auto& action : group.actionSet)
+        {
+            names.insert(action.name);
+        }
+    }
+    for (const auto& name : names)
+    {
+        ledIndexes.emplace(name, ledIndexes.size());
+    }
+    ledStates.resize(names.size());
+
+    for (const auto& [path, group] : ledMap)
     {
-        if (assertedGroups.contains(&ledMap.at(path)))
+        auto handle = groupEntries.size();
+        GroupEntry entry{&path, &group, {}};
+        for (const auto& action : group.actionSet)
         {
-            assertedGroups.erase(&ledMap.at(path));
+            entry.actions.push_back({ledIndexes.at(action.name), &action});
+
+            // Index the groups of each LED
+            ledGroups[action.name].push_back({handle, &action});
         }
+        changedLeds.reserve(
+            std::max(changedLeds.capacity(), entry.actions.size()));
+        spareNodes.reserve(
+            std::max(spareNodes.capacity(), 2 * entry.actions.size()));
+        groupEntries.push_back(std::move(entry));
+        groupHandles.emplace(path, handle);
+    }
+    assertedBits.resize(groupEntries.size());
+
+    // Resolve the rule of the configuration once, the group bits follow the
+    // group priorities with the group priority rule
+    priorityMode = getPriorityMode(ledMap);
+    for (GroupHandle handle = 0; handle < groupEntries.size(); ++handle)
+    {
+        bitGroups.push_back(handle);
+    }
+    if (priorityMode == PriorityMode::group)
+    {
+        std::ranges::sort(bitGroups, {}, [this](GroupHandle handle) {
+            return std::pair(groupEntries[handle].group->priority, handle);
+        });
+        resolveLed = &Manager::resolveState<PriorityMode::group>;
+    }
+    else
+    {
+        resolveLed = &Manager::resolveState<PriorityMode::led>;
+    }
+    groupBits.resize(groupEntries.size());
+    for (size_t bit = 0; bit < bitGroups.size(); ++bit)
+    {
+        groupBits[bitGroups[bit]] = bit;
     }
 
-    // create the new map from the asserted groups
-    auto newState = getNewMap(assertedGroups);
+    assertedRow.resize((groupEntries.size() + wordBits - 1) / wordBits);
+
+    std::vector<std::vector<size_t>> memberBits(names.size());
+    for (const auto& entry : groupEntries)
+    {
+        auto bit = groupBits[&entry - groupEntries.data()];
+        for (const auto& [index, action] : entry.actions)
+        {
+            memberBits[index].push_back(bit);
+        }
+    }
+    memberRows = makeRows(memberBits);
 
-    // the ledsAssert are those that are in the new map and change state
-    // + those in the new map and not in the old map
-    for (const auto& [name, action] : newState)
+    if (priorityMode == PriorityMode::led)
     {
-        if (ledStateMap.contains(name))
+        // The priority of an LED is the same in all the groups
+        std::vector<std::optional<Layout::Action>> priorities(names.size());
+        for (const auto& entry : groupEntries)
         {
-            // check if the led action has changed
-            auto& currentAction = ledStateMap[name];
+            for (const auto& [index, action] : entry.actions)
+            {
+                if (action->priority)
+                {
+                    priorities[index] = action->priority;
+                }
+            }
+        }
 
-            if (currentAction.action == action.action)
+        std::vector<std::vector<size_t>> priorityBits(names.size());
+        for (const auto& entry : groupEntries)
+        {
+            auto bit = groupBits[&entry - groupEntries.data()];
+            for (const auto& [index, action] : entry.actions)
             {
-                continue;
+                if (action->action == priorities[index])
+                {
+                    priorityBits[index].push_back(bit);
+                }
             }
         }
+        priorityRows = makeRows(priorityBits);
+    }
+}
+
+const Layout::LedAction* Manager::findLedState(const LedName& name) const
+{
+    auto it = ledIndexes.find(name);
+    if (it == ledIndexes.end())
+    {
+        return nullptr;
+    }
+    return ledStates[it->second];
+}
+
+std::optional<GroupHandle> Manager::findGroupHandle(
+    const std::string& path) const
+{
+    auto it = groupHandles.find(path);
+    if (it == groupHandles.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+bool Manager::setGroupState(const std::string& path, bool assert,
+                            ActionSet& ledsAssert, ActionSet& ledsDeAssert)
+{
+    auto handle = findGroupHandle(path);
+    if (!handle)
+    {
+        throw std::out_of_range("Unknown LED group " + path);
+    }
+    return setGroupState(*handle, assert, ledsAssert, ledsDeAssert);
+}
+
+// Assert -or- De-assert
+bool Manager::setGroupState(GroupHandle handle, bool assert,
+                            ActionSet& ledsAssert, ActionSet& ledsDeAssert)
+{
+    assertedBits.at(handle) = assert;
 
-        ledsAssert.insert(action);
+    auto bit = groupBits[handle];
+    auto mask = uint64_t{1} << (bit % wordBits);
+    if (assert)
+    {
+        assertedRow[bit / wordBits] |= mask;
+    }
+    else
+    {
+        assertedRow[bit / wordBits] &= ~mask;
     }
 
-    // the ledsDeAssert are those in the old map but not in the new map
-    for (const auto& [name, action] : ledStateMap)
+    // only the LEDs of the group can change, resolve them again
+    changedLeds.clear();
+    for (const auto& [index, action] : groupEntries[handle].actions)
     {
-        if (!newState.contains(name))
+        const auto* current = ledStates[index];
+        const auto* next = (this->*resolveLed)(index);
+
+        // the ledsAssert are those that are in the new states and change
+        // state + those in the new states and not in the old states
+        if (next != nullptr &&
+            (current == nullptr || current->action != next->action))
         {
-            ledsDeAssert.insert(action);
+            insertAction(ledsAssert, *next);
         }
+
+        // the ledsDeAssert are those in the old states but not in the new
+        // states
+        if (current != nullptr && next == nullptr)
+        {
+            insertAction(ledsDeAssert, *current);
+        }
+
+        if (current != next)
+        {
+            changedLeds.push_back(index);
+        }
+        ledStates[index] = next;
     }
 
-    ledStateMap = newState;
+    if (snapshotPtr)
+    {
+        snapshotPtr->update(ledStates, changedLeds, handle, assert);
+    }
 
     // If we survive, then set the state accordingly.
     return assert;
 }
 
+void Manager::insertAction(ActionSet& leds, const Layout::LedAction& action)
+{
+    if (spareNodes.empty())
+    {
+        leds.insert(action);
+        return;
+    }
+
+    // The name keeps the capacity of the node, it is not reallocated
+    auto node = std::move(spareNodes.back());
+    spareNodes.pop_back();
+    node.value() = action;
+
+    auto result = leds.insert(std::move(node));
+    if (!result.inserted)
+    {
+        spareNodes.push_back(std::move(result.node));
+    }
+}
+
+void Manager::recycle(ActionSet& leds)
+{
+    // The spare nodes are bounded by the reserved capacity
+    while (!leds.empty() && spareNodes.size() < spareNodes.capacity())
+    {
+        spareNodes.push_back(leds.extract(leds.begin()));
+    }
+    leds.clear();
+}
+
 void Manager::setLampTestCallBack(
     std::function<bool(ActionSet& ledsAssert, ActionSet& ledsDeAssert)>
         callBack)
@@ -168,6 +440,115 @@ void Manager::setLampTestCallBack(
     lampTestCallBack = callBack;
 }
 
+void Manager::setSnapshot(std::shared_ptr<snapshot::Writer> writer)
+{
+    snapshotPtr = std::move(writer);
+    if (snapshotPtr)
+    {
+        snapshotPtr->update(ledStates, assertedBits);
+    }
+}
+
+std::map<LedName, Layout::LedAction> Manager::getLedStates() const
+{
+    std::map<LedName, Layout::LedAction> states;
+    for (const auto* action : ledStates)
+    {
+        if (action != nullptr)
+        {
+            states.emplace(action->name, *action);
+        }
+    }
+    return states;
+}
+
+std::vector<std::string> Manager::getAssertedGroups() const
+{
+    std::vector<std::string> paths;
+    for (GroupHandle handle = 0; handle < assertedBits.size(); ++handle)
+    {
+        if (assertedBits[handle])
+        {
+            paths.emplace_back(*groupEntries[handle].path);
+        }
+    }
+    return paths;
+}
+
+Manager::Explanation Manager::explain(const LedName& name) const
+{
+    Explanation explanation;
+    auto groups = ledGroups.find(name);
+    if (groups == ledGroups.end())
+    {
+        return explanation;
+    }
+
+    const auto* state = findLedState(name);
+    const Layout::LedAction* first = nullptr;
+    bool conflict = false;
+    for (const auto& contributor : groups->second)
+    {
+        if (!assertedBits[contributor.handle])
+        {
+            continue;
+        }
+        const auto* action = contributor.action;
+        const auto& entry = groupEntries[contributor.handle];
+        explanation.contributors.emplace_back(*entry.path, action->action);
+
+        // The contributors conflict when they request different states
+        if (first == nullptr)
+        {
+            first = action;
+        }
+        else if (action->action != first->action ||
+                 action->dutyOn != first->dutyOn ||
+                 action->period != first->period)
+        {
+            conflict = true;
+        }
+
+        // The winner is the group whose action the LED was resolved to
+        if (action == state)
+        {
+            explanation.winner = *entry.path;
+        }
+    }
+
+    // A rule chooses the winner only when the contributors conflict
+    if (!explanation.winner.empty() && conflict)
+    {
+        explanation.rule = priorityMode == PriorityMode::group
+                               ? Rule::groupPriority
+                               : Rule::ledPriority;
+    }
+    return explanation;
+}
+
+// Erase the actions of the LEDs which have a changed action, both sets are
+// sorted by LED name
+static void discardChanged(ActionSet& required, const ActionSet& changed)
+{
+    auto it = required.begin();
+    auto next = changed.begin();
+    while (it != required.end() && next != changed.end())
+    {
+        if (it->name < next->name)
+        {
+            ++it;
+        }
+        else if (next->name < it->name)
+        {
+            ++next;
+        }
+        else
+        {
+            it = required.erase(it);
+        }
+    }
+}
+
 /** @brief Run through the map and apply action on the LEDs */
 void Manager::driveLEDs(ActionSet& ledsAssert, ActionSet& ledsDeAssert)
 {
@@ -182,33 +563,17 @@ void Manager::driveLEDs(ActionSet& ledsAssert, ActionSet& ledsDeAssert)
         }
     }
 
-    ActionSet newReqChangedLeds;
-    std::vector<std::pair<ActionSet&, ActionSet&>> actionsVec = {
-        {reqLedsAssert, ledsAssert}, {reqLedsDeAssert, ledsDeAssert}};
-
     timer.setEnabled(false);
-    std::set_union(ledsAssert.begin(), ledsAssert.end(), ledsDeAssert.begin(),
-                   ledsDeAssert.end(),
-                   std::inserter(newReqChangedLeds, newReqChangedLeds.begin()),
-                   ledLess);
 
-    // prepare reqLedsAssert & reqLedsDeAssert
-    for (auto pair : actionsVec)
+    // Discard current required LED actions, if these LEDs have new actions,
+    // and add the new LED actions.
+    for (const auto* changed : {&ledsAssert, &ledsDeAssert})
     {
-        ActionSet tmpSet;
-
-        // Discard current required LED actions, if these LEDs have new actions
-        // in newReqChangedLeds.
-        std::set_difference(pair.first.begin(), pair.first.end(),
-                            newReqChangedLeds.begin(), newReqChangedLeds.end(),
-                            std::inserter(tmpSet, tmpSet.begin()), ledLess);
-
-        // Union the remaining LED actions with new LED actions.
-        pair.first.clear();
-        std::set_union(tmpSet.begin(), tmpSet.end(), pair.second.begin(),
-                       pair.second.end(),
-                       std::inserter(pair.first, pair.first.begin()), ledLess);
+        discardChanged(reqLedsAssert, *changed);
+        discardChanged(reqLedsDeAssert, *changed);
     }
+    reqLedsAssert.insert(ledsAssert.begin(), ledsAssert.end());
+    reqLedsDeAssert.insert(ledsDeAssert.begin(), ledsDeAssert.end());
 
     driveLedsHandler();
     return;
@@ -1,16 +1,25 @@
 #pragma once
 
+#include "config-validator.hpp"
 #include "grouplayout.hpp"
 #include "ledlayout.hpp"
+#include "snapshot-writer.hpp"
 #include "utils.hpp"
 
 #include <sdeventplus/event.hpp>
 #include <sdeventplus/utility/timer.hpp>
 
 #include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
 #include <set>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 // to better see what the string is representing
 using LedName = std::string;
@@ -23,6 +32,40 @@ using namespace phosphor::led::utils;
 
 static constexpr auto phyLedPath = "/xyz/openbmc_project/led/physical/";
 
+/** @brief Handle of a group, resolved once from its path */
+using GroupHandle = size_t;
+
+/** @brief A word of a row of group bits */
+struct RowWord
+{
+    /** @brief Index of the word in the row */
+    size_t word;
+
+    /** @brief The bits of the word */
+    uint64_t bits;
+};
+
+/** @brief Rows of group bits, one per LED index
+ *  @details The rows are sparse, only the words with a bit set are kept, so
+ *  the size follows the number of groups of each LED and not the number of
+ *  groups of the configuration.
+ */
+struct BitRows
+{
+    /** @brief Start of the words of each row, then the end of the last row */
+    std::vector<size_t> offsets;
+
+    /** @brief The words of the rows, by increasing index in their row */
+    std::vector<RowWord> words;
+
+    /** @brief Get the words of a row */
+    std::span<const RowWord> row(size_t index) const
+    {
+        return std::span(words).subspan(offsets[index],
+                                        offsets[index + 1] - offsets[index]);
+    }
+};
+
 /** @class Manager
  *  @brief Manages group of LEDs and applies action on the elements of group
  */
@@ -71,6 +114,29 @@ class Manager
     /** @brief static global map constructed at compile time */
     const GroupMap& ledMap;
 
+    /** @brief Rule choosing the group whose action an LED takes */
+    enum class Rule
+    {
+        none,
+        ledPriority,
+        groupPriority,
+    };
+
+    /** @brief Why an LED is in its state */
+    struct Explanation
+    {
+        /** @brief The asserted groups containing the LED and their actions */
+        std::vector<std::pair<std::string, Layout::Action>> contributors;
+
+        /** @brief Path of the group whose action the LED takes, empty when
+         *         the LED is off */
+        std::string winner;
+
+        /** @brief Rule choosing the winner, none when the asserted groups
+         *         request the same state */
+        Rule rule = Rule::none;
+    };
+
     /** @brief Refer the user supplied LED layout and sdbusplus handler
      *
      *  @param [in] bus       - sdbusplus handler
@@ -82,13 +148,35 @@ class Manager
         const sdeventplus::Event& event = sdeventplus::Event::get_default()) :
         ledMap(ledLayout), timer(event, [this](auto&) { driveLedsHandler(); })
     {
-        // Nothing here
+        indexGroups();
     }
 
     /* create the resulting map from all currently asserted groups */
-    static auto getNewMap(std::set<const Layout::GroupLayout*> assertedGroups)
+    static auto getNewMap(
+        const std::set<const Layout::GroupLayout*>& assertedGroups)
         -> std::map<LedName, Layout::LedAction>;
 
+    /** @brief Find the handle of a group
+     *
+     *  @param[in]  path  -  dbus path of group
+     *
+     *  @return The handle of the group, not set when it is not in the layout
+     */
+    std::optional<GroupHandle> findGroupHandle(const std::string& path) const;
+
+    /** @brief Given a group handle, applies the action on the group
+     *
+     *  @param[in]  handle        -  handle of the group
+     *  @param[in]  assert        -  Could be true or false
+     *  @param[in]  ledsAssert    -  LEDs that are to be asserted new
+     *                               or to a different state
+     *  @param[in]  ledsDeAssert  -  LEDs that are to be Deasserted
+     *
+     *  @return                   -  Success or exception thrown
+     */
+    bool setGroupState(GroupHandle handle, bool assert, ActionSet& ledsAssert,
+                       ActionSet& ledsDeAssert);
+
     /** @brief Given a group name, applies the action on the group
      *
      *  @param[in]  path          -  dbus path of group
@@ -102,6 +190,13 @@ class Manager
     bool setGroupState(const std::string& path, bool assert,
                        ActionSet& ledsAssert, ActionSet& ledsDeAssert);
 
+    /** @brief Keep the nodes of a set of LED actions for the next group
+     *         updates, so that they do not allocate
+     *
+     *  @param[in,out]  leds  -  LED actions, emptied
+     */
+    void recycle(ActionSet& leds);
+
     /** @brief Finds the set of LEDs to operate on and executes action
      *
      *  @param[in]  ledsAssert    -  LEDs that are to be asserted newly
@@ -133,15 +228,140 @@ class Manager
         std::function<bool(ActionSet& ledsAssert, ActionSet& ledsDeAssert)>
             callBack);
 
+    /** @brief Publish the LED states to a snapshot
+     *
+     *  @param[in]  writer   -  Writer of the snapshot
+     */
+    void setSnapshot(std::shared_ptr<snapshot::Writer> writer);
+
+    /** @brief Get the state of the LEDs computed from the asserted groups
+     *
+     *  @return Map of LED name to its action, the LEDs not in the map are off
+     */
+    std::map<LedName, Layout::LedAction> getLedStates() const;
+
+    /** @brief Get the asserted groups
+     *
+     *  @return The D-Bus paths of the asserted groups
+     */
+    std::vector<std::string> getAssertedGroups() const;
+
+    /** @brief Returns action string based on enum
+     *
+     *  @param[in]  action - Action enum
+     *
+     *  @return string equivalent of the passed in enumeration
+     */
+    static std::string getPhysicalAction(Layout::Action action);
+
+    /** @brief Explain the state of an LED
+     *
+     *  @param[in]  name - Name of the LED
+     *
+     *  @return The asserted groups containing the LED, the group whose action
+     *          the LED takes and the rule choosing it
+     */
+    Explanation explain(const LedName& name) const;
+
   private:
+    /** @brief An action of a group on an LED */
+    struct GroupAction
+    {
+        /** @brief Index of the LED */
+        size_t index;
+
+        /** @brief The action */
+        const Layout::LedAction* action;
+    };
+
+    /** @brief A group of the layout */
+    struct GroupEntry
+    {
+        /** @brief Path of the group */
+        const std::string* path;
+
+        /** @brief The group */
+        const Layout::GroupLayout* group;
+
+        /** @brief The actions of the group, with the index of their LED */
+        std::vector<GroupAction> actions;
+    };
+
+    /** @brief The groups, by handle */
+    std::vector<GroupEntry> groupEntries;
+
+    /** @brief The handles of the groups, the keys refer to ledMap */
+    std::unordered_map<std::string_view, GroupHandle> groupHandles;
+
+    /** @brief The asserted groups, by handle */
+    std::vector<bool> assertedBits;
+
+    /** @brief A group containing an LED */
+    struct Contributor
+    {
+        /** @brief Handle of the group */
+        GroupHandle handle;
+
+        /** @brief Action of the group on the LED */
+        const Layout::LedAction* action;
+    };
+
+    /** @brief The groups containing each LED */
+    std::unordered_map<LedName, std::vector<Contributor>> ledGroups;
+
+    /** @brief Rule of the configuration, resolved when the layout is
+     *         loaded */
+    PriorityMode priorityMode = PriorityMode::led;
+
+    /** @brief The bit of each group, by handle. The bits follow the group
+     *         priorities with the group priority rule, and the handles with
+     *         the LED priority rule */
+    std::vector<size_t> groupBits;
+
+    /** @brief The handle of each group bit */
+    std::vector<GroupHandle> bitGroups;
+
+    /** @brief The groups containing each LED */
+    BitRows memberRows;
+
+    /** @brief The groups requesting the priority action of each LED, used by
+     *         the LED priority rule */
+    BitRows priorityRows;
+
+    /** @brief The asserted groups, a row of group bits */
+    std::vector<uint64_t> assertedRow;
+
     /** Map of physical LED path to service name */
     std::unordered_map<std::string, std::string> phyLeds;
 
-    /** @brief Pointers to groups that are in asserted state */
-    std::set<const Layout::GroupLayout*> assertedGroups;
+    /** @brief The index of each LED, the LEDs are indexed in name order and
+     *         the keys refer to ledMap */
+    std::unordered_map<std::string_view, size_t> ledIndexes;
+
+    /** @brief The current action of each LED, by index, null when off */
+    std::vector<const Layout::LedAction*> ledStates;
+
+    /** @brief Resolve the action of an LED from the asserted groups, with
+     *         the rule of the configuration */
+    const Layout::LedAction* (Manager::*resolveLed)(size_t) const = nullptr;
+
+    /** @brief The LEDs changed by the last group update, by index, the
+     *         capacity is reserved for the largest group */
+    std::vector<size_t> changedLeds;
 
-    /** Map of led name to current state */
-    std::map<std::string, Layout::LedAction> ledStateMap;
+    /** @brief Nodes of LED actions kept for the group updates, the
+     *         capacity is reserved for the two sets of the largest group */
+    std::vector<ActionSet::node_type> spareNodes;
+
+    /** @brief Insert an LED action in a set, reusing a spare node
+     *
+     *  @param[in,out]  leds    -  LED actions
+     *  @param[in]      action  -  LED action inserted
+     */
+    void insertAction(ActionSet& leds, const Layout::LedAction& action);
+
+    /** @brief Writer of the snapshot of the LED states */
+    std::shared_ptr<snapshot::Writer> snapshotPtr;
 
     /** @brief Custom callback when enabled lamp test */
     std::function<bool(ActionSet& ledsAssert, ActionSet& ledsDeAssert)>
@@ -164,13 +384,37 @@ class Manager
     /** @brief LEDs handler callback */
     void driveLedsHandler();
 
-    /** @brief Returns action string based on enum
+    /** @brief Resolve the handles of the groups and the indexes of the LEDs,
+     *         and index the groups of each LED */
+    void indexGroups();
+
+    /** @brief Resolve the action of an LED from the asserted groups
      *
-     *  @param[in]  action - Action enum
+     *  @tparam mode - Rule of the configuration
      *
-     *  @return string equivalent of the passed in enumeration
+     *  @param[in]  index - Index of the LED
+     *
+     *  @return The action, null when the LED is off
      */
-    static std::string getPhysicalAction(Layout::Action action);
+    template <PriorityMode mode>
+    const Layout::LedAction* resolveState(size_t index) const;
+
+    /** @brief Find the action of a group on an LED
+     *
+     *  @param[in]  bit   - Bit of the group
+     *  @param[in]  index - Index of the LED
+     *
+     *  @return The action
+     */
+    const Layout::LedAction* findGroupAction(size_t bit, size_t index) const;
+
+    /** @brief Find the current action of an LED
+     *
+     *  @param[in]  name - Name of the LED
+     *
+     *  @return The action, null when the LED is off
+     */
+    const Layout::LedAction* findLedState(const LedName& name) const;
 };
 
 } // namespace led
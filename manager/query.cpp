@@ -0,0 +1,118 @@
+#include "query.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/exception.hpp>
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace phosphor
+{
+namespace led
+{
+
+int Query::getAllLedStates(sd_bus_message* msg, void* context,
+                           sd_bus_error* error)
+{
+    const auto& manager = static_cast<Query*>(context)->manager;
+    try
+    {
+        std::map<std::string, std::tuple<std::string, uint8_t, uint16_t>>
+            states;
+        for (const auto& [name, action] : manager.getLedStates())
+        {
+            states.emplace(
+                name,
+                std::make_tuple(Manager::getPhysicalAction(action.action),
+                                action.dutyOn, action.period));
+        }
+
+        auto reply = sdbusplus::message_t(msg).new_method_return();
+        reply.append(states);
+        reply.method_return();
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to reply the LED states, ERROR = {ERROR}", "ERROR",
+                   e);
+        return sd_bus_error_set(error, e.name(), e.description());
+    }
+    return 1;
+}
+
+int Query::getAssertedGroups(sd_bus_message* msg, void* context,
+                             sd_bus_error* error)
+{
+    const auto& manager = static_cast<Query*>(context)->manager;
+    try
+    {
+        std::vector<sdbusplus::object_path> paths;
+        for (auto& path : manager.getAssertedGroups())
+        {
+            paths.emplace_back(std::move(path));
+        }
+
+        auto reply = sdbusplus::message_t(msg).new_method_return();
+        reply.append(paths);
+        reply.method_return();
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to reply the asserted groups, ERROR = {ERROR}",
+                   "ERROR", e);
+        return sd_bus_error_set(error, e.name(), e.description());
+    }
+    return 1;
+}
+
+int Query::explain(sd_bus_message* msg, void* context, sd_bus_error* error)
+{
+    const auto& manager = static_cast<Query*>(context)->manager;
+    try
+    {
+        auto m = sdbusplus::message_t(msg);
+        std::string name;
+        m.read(name);
+
+        auto explanation = manager.explain(name);
+        std::vector<std::tuple<sdbusplus::object_path, std::string>>
+            contributors;
+        for (const auto& [path, action] : explanation.contributors)
+        {
+            contributors.emplace_back(path, Manager::getPhysicalAction(action));
+        }
+
+        const char* rule = "None";
+        if (explanation.rule == Manager::Rule::ledPriority)
+        {
+            rule = "LedPriority";
+        }
+        else if (explanation.rule == Manager::Rule::groupPriority)
+        {
+            rule = "GroupPriority";
+        }
+
+        // No winner when the LED is off
+        std::vector<sdbusplus::object_path> winner;
+        if (!explanation.winner.empty())
+        {
+            winner.emplace_back(explanation.winner);
+        }
+
+        auto reply = m.new_method_return();
+        reply.append(contributors, winner, std::string(rule));
+        reply.method_return();
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to explain the LED state, ERROR = {ERROR}", "ERROR",
+                   e);
+        return sd_bus_error_set(error, e.name(), e.description());
+    }
+    return 1;
+}
+
+} // namespace led
+} // namespace phosphor
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "manager.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+namespace phosphor
+{
+namespace led
+{
+
+/** @brief D-Bus interface of the LED state queries, private to this project
+ *         and defined by the vtable of Query
+ */
+static constexpr auto queryInterface = "org.openbmc.LedManager.Query";
+
+/** @class Query
+ *  @brief Bulk queries of the LED states
+ *  @details Front-ends read the whole LED picture in one call instead of the
+ *  Asserted property of every group and the state of every physical LED. The
+ *  replies are served from the state held by the Manager, the physical LEDs
+ *  are not read. Explain tells why an LED is in its state.
+ */
+class Query
+{
+  public:
+    Query() = delete;
+    ~Query() = default;
+    Query(const Query&) = delete;
+    Query& operator=(const Query&) = delete;
+    Query(Query&&) = delete;
+    Query& operator=(Query&&) = delete;
+
+    /** @brief Constructs Query
+     *
+     *  @param[in] bus     - Handle to system dbus
+     *  @param[in] objPath - The D-Bus path that hosts the queries
+     *  @param[in] manager - Reference to Manager
+     */
+    Query(sdbusplus::bus_t& bus, const char* objPath, const Manager& manager) :
+        manager(manager), intf(bus, objPath, queryInterface, vtable, this)
+    {}
+
+  private:
+    /** @brief Reference to Manager object */
+    const Manager& manager;
+
+    /** @brief GetAllLedStates method, returns the action, the duty on and
+     *         the period of each LED which is not off
+     */
+    static int getAllLedStates(sd_bus_message* msg, void* context,
+                               sd_bus_error* error);
+
+    /** @brief GetAssertedGroups method, returns the paths of the asserted
+     *         groups
+     */
+    static int getAssertedGroups(sd_bus_message* msg, void* context,
+                                 sd_bus_error* error);
+
+    /** @brief Explain method, returns the asserted groups containing an LED
+     *         and their actions, the group whose action the LED takes, none
+     *         when the LED is off, and the rule choosing it
+     */
+    static int explain(sd_bus_message* msg, void* context,
+                       sd_bus_error* error);
+
+    static constexpr sdbusplus::vtable_t vtable[] = {
+        sdbusplus::vtable::start(),
+        sdbusplus::vtable::method("GetAllLedStates", "", "a{s(syq)}",
+                                  getAllLedStates),
+        sdbusplus::vtable::method("GetAssertedGroups", "", "ao",
+                                  getAssertedGroups),
+        sdbusplus::vtable::method("Explain", "s", "a(os)aos", explain),
+        sdbusplus::vtable::end()};
+
+    /** @brief The D-Bus interface of the queries */
+    sdbusplus::server::interface_t intf;
+};
+
+} // namespace led
+} // namespace phosphor
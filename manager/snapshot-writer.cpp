@@ -0,0 +1,261 @@
+#include "snapshot-writer.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <new>
+#include <set>
+#include <string>
+#include <utility>
+
+namespace phosphor
+{
+namespace led
+{
+namespace snapshot
+{
+
+/** @brief Get the snapshot state of an LED action */
+static LedState getLedState(Layout::Action action)
+{
+    if (action == Layout::Action::On)
+    {
+        return LedState::on;
+    }
+    if (action == Layout::Action::Blink)
+    {
+        return LedState::blink;
+    }
+    return LedState::off;
+}
+
+/** @brief Retire the snapshot file being replaced, its readers map the new
+ *         one
+ *
+ *  @param[in] path - Path of the snapshot file
+ */
+static void retire(const fs::path& path)
+{
+    int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    struct stat st{};
+    void* addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 &&
+        static_cast<size_t>(st.st_size) >= sizeof(Header))
+    {
+        addr = mmap(nullptr, sizeof(Header), PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        return;
+    }
+
+    // The sequence stays odd, a reader of the file never completes a read
+    auto* header = static_cast<Header*>(addr);
+    if (header->magic == magic && header->version == version)
+    {
+        header->retired.store(1, std::memory_order_relaxed);
+        auto sequence = header->sequence.load(std::memory_order_relaxed);
+        header->sequence.store(sequence | 1, std::memory_order_release);
+    }
+    munmap(addr, sizeof(Header));
+}
+
+Writer::Writer(const fs::path& path, const GroupMap& groups)
+{
+    std::set<std::string> leds;
+    for (const auto& [name, group] : groups)
+    {
+        for (const auto& action : group.actionSet)
+        {
+            leds.insert(action.name);
+        }
+    }
+    size = getSize(leds.size(), groups.size());
+
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+
+    auto tmpPath = path;
+    tmpPath += ".tmp";
+    int fd = open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  0644);
+    if (fd < 0)
+    {
+        lg2::error("Failed to create the LED snapshot, ERRNO = {ERRNO}, "
+                   "FILE_PATH = {PATH}",
+                   "ERRNO", errno, "PATH", tmpPath);
+        return;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+    {
+        void* addr =
+            mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED)
+        {
+            base = static_cast<uint8_t*>(addr);
+        }
+    }
+    close(fd);
+
+    if (base == nullptr)
+    {
+        lg2::error("Failed to map the LED snapshot, ERRNO = {ERRNO}, "
+                   "FILE_PATH = {PATH}",
+                   "ERRNO", errno, "PATH", tmpPath);
+        fs::remove(tmpPath, ec);
+        return;
+    }
+
+    auto* header = new (base) Header{};
+    header->magic = magic;
+    header->version = version;
+    header->ledCount = leds.size();
+    header->groupCount = groups.size();
+
+    auto* ledRecord = reinterpret_cast<LedRecord*>(base + sizeof(Header));
+    for (const auto& name : leds)
+    {
+        auto* record = new (ledRecord++) LedRecord{};
+        name.copy(record->name, nameSize - 1);
+        ledRecords.push_back(record);
+    }
+
+    // Sort the groups so that the layout does not depend on the hashing,
+    // the records are kept in the order of the layout
+    std::vector<std::pair<const GroupMap::value_type*, size_t>> sorted;
+    for (const auto& entry : groups)
+    {
+        sorted.emplace_back(&entry, sorted.size());
+    }
+    std::ranges::sort(sorted, {}, [](const auto& entry) {
+        return entry.first->first;
+    });
+
+    groupRecords.resize(groups.size());
+    auto* groupRecord = reinterpret_cast<GroupRecord*>(ledRecord);
+    for (const auto& [entry, order] : sorted)
+    {
+        auto* record = new (groupRecord++) GroupRecord{};
+        entry->first.copy(record->path, pathSize - 1);
+        groupRecords[order] = record;
+    }
+
+    retire(path);
+    fs::rename(tmpPath, path, ec);
+    if (ec)
+    {
+        lg2::error("Failed to publish the LED snapshot, ERROR = {ERROR}, "
+                   "FILE_PATH = {PATH}",
+                   "ERROR", ec.message(), "PATH", path);
+    }
+}
+
+Writer::~Writer()
+{
+    if (base != nullptr)
+    {
+        munmap(base, size);
+    }
+}
+
+Header* Writer::beginUpdate()
+{
+    if (base == nullptr)
+    {
+        return nullptr;
+    }
+
+    // Another writer replaced the file
+    auto* header = reinterpret_cast<Header*>(base);
+    if (header->retired.load(std::memory_order_relaxed) != 0)
+    {
+        return nullptr;
+    }
+
+    auto sequence = header->sequence.load(std::memory_order_relaxed);
+    header->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return header;
+}
+
+void Writer::endUpdate(Header* header)
+{
+    auto sequence = header->sequence.load(std::memory_order_relaxed);
+    header->sequence.store(sequence + 1, std::memory_order_release);
+}
+
+void Writer::writeLed(size_t index, const Layout::LedAction* action)
+{
+    auto state = action == nullptr
+                     ? packState(LedState::off, 0, 0)
+                     : packState(getLedState(action->action), action->dutyOn,
+                                 action->period);
+    ledRecords[index]->state.store(state, std::memory_order_relaxed);
+}
+
+void Writer::update(std::span<const Layout::LedAction* const> leds,
+                    const std::vector<bool>& asserted)
+{
+    if (leds.size() != ledRecords.size() ||
+        asserted.size() != groupRecords.size())
+    {
+        return;
+    }
+
+    auto* header = beginUpdate();
+    if (header == nullptr)
+    {
+        return;
+    }
+
+    for (size_t index = 0; index < ledRecords.size(); ++index)
+    {
+        writeLed(index, leds[index]);
+    }
+
+    for (size_t index = 0; index < groupRecords.size(); ++index)
+    {
+        groupRecords[index]->asserted.store(asserted[index] ? 1 : 0,
+                                            std::memory_order_relaxed);
+    }
+
+    endUpdate(header);
+}
+
+void Writer::update(std::span<const Layout::LedAction* const> leds,
+                    std::span<const size_t> changed, size_t group,
+                    bool asserted)
+{
+    if (leds.size() != ledRecords.size() || group >= groupRecords.size())
+    {
+        return;
+    }
+
+    auto* header = beginUpdate();
+    if (header == nullptr)
+    {
+        return;
+    }
+
+    for (auto index : changed)
+    {
+        writeLed(index, leds[index]);
+    }
+    groupRecords[group]->asserted.store(asserted ? 1 : 0,
+                                        std::memory_order_relaxed);
+
+    endUpdate(header);
+}
+
+} // namespace snapshot
+} // namespace led
+} // namespace phosphor
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "grouplayout.hpp"
+#include "snapshot.hpp"
+
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace phosphor
+{
+namespace led
+{
+namespace snapshot
+{
+
+namespace fs = std::filesystem;
+
+/** @class Writer
+ *  @brief Publish the LED states to the snapshot file
+ *  @details The LEDs and the groups of the configuration are laid out once,
+ *  only their states are written on updates, and only the records changed
+ *  by a group update are written. The file is built aside and renamed in
+ *  place so that readers never map a partial file, the file it replaces is
+ *  retired first so that its readers map the new one.
+ */
+class Writer
+{
+  public:
+    Writer() = delete;
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    Writer(Writer&&) = delete;
+    Writer& operator=(Writer&&) = delete;
+
+    /** @brief Create the snapshot file
+     *
+     *  @param[in] path   - Path of the snapshot file
+     *  @param[in] groups - LEDs group layout
+     */
+    Writer(const fs::path& path, const GroupMap& groups);
+
+    ~Writer();
+
+    /** @brief Write the states of the LEDs and the groups
+     *
+     *  @param[in] leds     - The action of each LED in name order, null when
+     *                        the LED is off
+     *  @param[in] asserted - Whether each group is asserted, in the order of
+     *                        the layout
+     */
+    void update(std::span<const Layout::LedAction* const> leds,
+                const std::vector<bool>& asserted);
+
+    /** @brief Write the states changed by a group update
+     *
+     *  @param[in] leds     - The action of each LED in name order, null when
+     *                        the LED is off
+     *  @param[in] changed  - Indexes of the LEDs whose state changed
+     *  @param[in] group    - Index of the group in the order of the layout
+     *  @param[in] asserted - Whether the group is asserted
+     */
+    void update(std::span<const Layout::LedAction* const> leds,
+                std::span<const size_t> changed, size_t group, bool asserted);
+
+  private:
+    /** @brief The mapped snapshot file, null when it could not be created */
+    uint8_t* base = nullptr;
+
+    /** @brief Size of the mapping */
+    size_t size = 0;
+
+    /** @brief The record of each LED, in name order */
+    std::vector<LedRecord*> ledRecords;
+
+    /** @brief The record of each group, in the order of the layout */
+    std::vector<GroupRecord*> groupRecords;
+
+    /** @brief Start writing the snapshot
+     *
+     *  @return The header of the snapshot, null when it cannot be written
+     */
+    Header* beginUpdate();
+
+    /** @brief Publish the records written since beginUpdate
+     *
+     *  @param[in] header - The header returned by beginUpdate
+     */
+    static void endUpdate(Header* header);
+
+    /** @brief Write the state of an LED
+     *
+     *  @param[in] index  - Index of the LED
+     *  @param[in] action - The action of the LED, null when it is off
+     */
+    void writeLed(size_t index, const Layout::LedAction* action);
+};
+
+} // namespace snapshot
+} // namespace led
+} // namespace phosphor
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+namespace led
+{
+/** @namespace snapshot
+ *  @brief Shared memory snapshot of the LED states
+ *  @details The manager publishes the computed state of each LED and the
+ *  asserted state of each group in a memory-mapped file. Local readers map
+ *  the file and read a consistent view without any IPC. The snapshot is
+ *  protected by a sequence lock: the sequence is odd while the manager
+ *  writes, and a reader retries when the sequence changed during its read.
+ *  When the manager restarts, it retires the file it replaces and its
+ *  readers map the new file.
+ *
+ *  This header has no dependency on the rest of the manager so that readers
+ *  can include it alone.
+ */
+namespace snapshot
+{
+
+/** @brief Magic of the snapshot file, "LEDS" */
+static constexpr uint32_t magic = 0x5344454c;
+
+/** @brief Version of the layout of the snapshot file */
+static constexpr uint32_t version = 2;
+
+/** @brief Maximum length of an LED name, including the terminating NUL */
+static constexpr size_t nameSize = 64;
+
+/** @brief Maximum length of a group path, including the terminating NUL */
+static constexpr size_t pathSize = 192;
+
+/** @brief State of an LED */
+enum class LedState : uint8_t
+{
+    off,
+    on,
+    blink,
+};
+
+/** @brief Header of the snapshot file */
+struct Header
+{
+    uint32_t magic;
+    uint32_t version;
+
+    /** @brief Sequence lock, odd while the snapshot is written */
+    std::atomic<uint64_t> sequence;
+
+    uint32_t ledCount;
+    uint32_t groupCount;
+
+    /** @brief Set when the file was replaced, the sequence then stays odd */
+    std::atomic<uint32_t> retired;
+};
+
+/** @brief An LED of the snapshot, the records follow the header */
+struct LedRecord
+{
+    char name[nameSize];
+
+    /** @brief The LedState, the duty on and the period, see packState */
+    std::atomic<uint32_t> state;
+};
+
+/** @brief A group of the snapshot, the records follow the LED records */
+struct GroupRecord
+{
+    char path[pathSize];
+    std::atomic<uint32_t> asserted;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+/** @brief Number of attempts of a reader before giving up, the manager
+ *         died while writing */
+static constexpr size_t maxAttempts = 10000;
+
+/** @brief Size of a snapshot file */
+inline size_t getSize(size_t ledCount, size_t groupCount)
+{
+    return sizeof(Header) + (ledCount * sizeof(LedRecord)) +
+           (groupCount * sizeof(GroupRecord));
+}
+
+/** @brief Pack the state of an LED in a record */
+inline uint32_t packState(LedState state, uint8_t dutyOn, uint16_t period)
+{
+    return static_cast<uint32_t>(state) |
+           (static_cast<uint32_t>(dutyOn) << 8) |
+           (static_cast<uint32_t>(period) << 16);
+}
+
+/** @brief The state of an LED read from the snapshot */
+struct Led
+{
+    std::string name;
+    LedState state;
+    uint8_t dutyOn;
+    uint16_t period;
+};
+
+/** @brief The state of a group read from the snapshot */
+struct Group
+{
+    std::string path;
+    bool asserted;
+};
+
+/** @class Reader
+ *  @brief Read the snapshot published by the manager
+ */
+class Reader
+{
+  public:
+    Reader() = delete;
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+    Reader(Reader&&) = delete;
+    Reader& operator=(Reader&&) = delete;
+
+    /** @brief Map the snapshot file
+     *
+     *  @param[in] path - Path of the snapshot file
+     */
+    explicit Reader(const std::string& path) : path(path)
+    {
+        map();
+    }
+
+    ~Reader()
+    {
+        unmap();
+    }
+
+    /** @brief Whether the snapshot file is mapped */
+    bool valid() const
+    {
+        return base != nullptr;
+    }
+
+    /** @brief Read a consistent view of the LEDs and the groups, the file is
+     *         mapped again when it was replaced
+     *
+     *  @param[out] leds   - The LEDs
+     *  @param[out] groups - The groups
+     *
+     *  @return false when the snapshot is not mapped or no consistent view
+     *          was read
+     */
+    bool read(std::vector<Led>& leds, std::vector<Group>& groups)
+    {
+        for (size_t attempt = 0; attempt < maxAttempts; ++attempt)
+        {
+            const auto* h = header();
+            if (h == nullptr ||
+                h->retired.load(std::memory_order_acquire) != 0)
+            {
+                // Not created yet, or replaced by a restarted manager
+                unmap();
+                map();
+                if (base == nullptr)
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            if (readOnce(*h, leds, groups))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+  private:
+    /** @brief Path of the snapshot file */
+    std::string path;
+
+    /** @brief The mapped snapshot file */
+    const uint8_t* base = nullptr;
+
+    /** @brief Size of the mapping */
+    size_t size = 0;
+
+    /** @brief The header of the mapped snapshot, null when not mapped */
+    const Header* header() const
+    {
+        return reinterpret_cast<const Header*>(base);
+    }
+
+    /** @brief Map the snapshot file, not mapped when it is not valid */
+    void map()
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        struct stat st{};
+        if (fstat(fd, &st) == 0 &&
+            static_cast<size_t>(st.st_size) >= sizeof(Header))
+        {
+            void* addr =
+                mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (addr != MAP_FAILED)
+            {
+                base = static_cast<const uint8_t*>(addr);
+                size = st.st_size;
+            }
+        }
+        close(fd);
+
+        const auto* h = header();
+        if (h != nullptr &&
+            (h->magic != magic || h->version != version ||
+             getSize(h->ledCount, h->groupCount) > size))
+        {
+            unmap();
+        }
+    }
+
+    /** @brief Unmap the snapshot file */
+    void unmap()
+    {
+        if (base != nullptr)
+        {
+            munmap(const_cast<uint8_t*>(base), size);
+            base = nullptr;
+            size = 0;
+        }
+    }
+
+    /** @brief Attempt to read a consistent view of the snapshot
+     *
+     *  @param[in]  h      - The header of the mapped snapshot
+     *  @param[out] leds   - The LEDs
+     *  @param[out] groups - The groups
+     *
+     *  @return false when the snapshot was written during the read
+     */
+    bool readOnce(const Header& h, std::vector<Led>& leds,
+                  std::vector<Group>& groups) const
+    {
+        const auto* ledRecords =
+            reinterpret_cast<const LedRecord*>(base + sizeof(Header));
+        const auto* groupRecords = reinterpret_cast<const GroupRecord*>(
+            base + sizeof(Header) + (h.ledCount * sizeof(LedRecord)));
+
+        auto begin = h.sequence.load(std::memory_order_acquire);
+        if ((begin & 1) != 0)
+        {
+            return false;
+        }
+
+        leds.clear();
+        for (uint32_t i = 0; i < h.ledCount; ++i)
+        {
+            auto state = ledRecords[i].state.load(std::memory_order_relaxed);
+            leds.push_back(
+                {std::string(ledRecords[i].name,
+                             strnlen(ledRecords[i].name, nameSize)),
+                 static_cast<LedState>(state & 0xff),
+                 static_cast<uint8_t>((state >> 8) & 0xff),
+                 static_cast<uint16_t>(state >> 16)});
+        }
+
+        groups.clear();
+        for (uint32_t i = 0; i < h.groupCount; ++i)
+        {
+            groups.push_back(
+                {std::string(groupRecords[i].path,
+                             strnlen(groupRecords[i].path, pathSize)),
+                 groupRecords[i].asserted.load(std::memory_order_relaxed) !=
+                     0});
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return h.sequence.load(std::memory_order_relaxed) == begin;
+    }
+};
+
+} // namespace snapshot
+} // namespace led
+} // namespace phosphor
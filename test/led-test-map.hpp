@@ -248,3 +248,22 @@ static const phosphor::led::GroupMap
                phosphor::led::Layout::Action::Blink},
           }}},
 };
+
+static const phosphor::led::GroupMap twoGroupsWithOneComonLEDBlinkDiffPeriod = {
+    {"/xyz/openbmc_project/ledmanager/groups/MultipleLedsASet",
+     {0,
+      {
+          {"One", phosphor::led::Layout::Action::On, 0, 0,
+           phosphor::led::Layout::Action::On},
+          {"Three", phosphor::led::Layout::Action::Blink, 50, 1000,
+           phosphor::led::Layout::Action::On},
+      }}},
+    {"/xyz/openbmc_project/ledmanager/groups/MultipleLedsBSet",
+     {0,
+      {
+          {"Three", phosphor::led::Layout::Action::Blink, 20, 500,
+           phosphor::led::Layout::Action::On},
+          {"Six", phosphor::led::Layout::Action::On, 0, 0,
+           phosphor::led::Layout::Action::On},
+      }}},
+};
@@ -0,0 +1,171 @@
+#include "manager.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::led;
+
+// Count the heap allocations of the whole test program
+static std::atomic<size_t> allocations{0};
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+// The replaced operator new allocates with malloc
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+static const GroupMap sharedLedGroups = {
+    {"/xyz/openbmc_project/ledmanager/groups/groupA",
+     {0,
+      {
+          {"led1", Layout::Action::On, 0, 0, Layout::Action::On},
+          {"led2", Layout::Action::Blink, 50, 1000, Layout::Action::Blink},
+      }}},
+    {"/xyz/openbmc_project/ledmanager/groups/groupB",
+     {0,
+      {
+          {"led1", Layout::Action::On, 0, 0, Layout::Action::On},
+          {"led2", Layout::Action::Blink, 50, 1000, Layout::Action::Blink},
+      }}},
+};
+
+static const GroupMap rankedGroups = {
+    {"/xyz/openbmc_project/ledmanager/groups/groupA",
+     {1,
+      {
+          {"led1", Layout::Action::Blink, 50, 1000, std::nullopt},
+      }}},
+    {"/xyz/openbmc_project/ledmanager/groups/groupB",
+     {2,
+      {
+          {"led1", Layout::Action::On, 0, 0, std::nullopt},
+      }}},
+};
+
+// The names are longer than the small string buffer
+static const GroupMap distinctLedGroups = {
+    {"/xyz/openbmc_project/ledmanager/groups/groupA",
+     {0,
+      {
+          {"front_fan0_fault_led", Layout::Action::On, 0, 0,
+           Layout::Action::On},
+          {"front_fan1_fault_led", Layout::Action::Blink, 50, 1000,
+           Layout::Action::Blink},
+      }}},
+    {"/xyz/openbmc_project/ledmanager/groups/groupB",
+     {0,
+      {
+          {"rear_psu0_fault_led", Layout::Action::On, 0, 0,
+           Layout::Action::On},
+      }}},
+};
+
+static constexpr auto groupA = "/xyz/openbmc_project/ledmanager/groups/groupA";
+static constexpr auto groupB = "/xyz/openbmc_project/ledmanager/groups/groupB";
+
+/** @brief Toggle Set-A while Set-B keeps the LEDs in the same state, and
+ *         count the allocations */
+static size_t toggleAllocations(const GroupMap& groups)
+{
+    const std::string pathA = groupA;
+
+    auto bus = sdbusplus::bus::new_default();
+    Manager manager(bus, groups);
+    manager.setLampTestCallBack([](ActionSet&, ActionSet&) { return false; });
+
+    ActionSet ledsAssert{};
+    ActionSet ledsDeAssert{};
+    manager.setGroupState(groupB, true, ledsAssert, ledsDeAssert);
+    ledsAssert.clear();
+
+    auto handleA = manager.findGroupHandle(pathA);
+    EXPECT_TRUE(handleA);
+
+    auto before = allocations.load();
+    for (int i = 0; i < 100; ++i)
+    {
+        manager.setGroupState(*handleA, (i % 2) == 0, ledsAssert,
+                              ledsDeAssert);
+        manager.driveLEDs(ledsAssert, ledsDeAssert);
+        manager.setGroupState(pathA, (i % 2) != 0, ledsAssert, ledsDeAssert);
+        manager.driveLEDs(ledsAssert, ledsDeAssert);
+    }
+    auto count = allocations.load() - before;
+
+    EXPECT_TRUE(ledsAssert.empty());
+    EXPECT_TRUE(ledsDeAssert.empty());
+    return count;
+}
+
+/** @brief Toggling a group which does not change the LEDs does not allocate */
+TEST(AllocationTest, steadyStateToggle)
+{
+    EXPECT_EQ(0, toggleAllocations(sharedLedGroups));
+}
+
+/** @brief Same with the group priorities, Set-B has the highest priority */
+TEST(AllocationTest, steadyStateToggleGroupPriority)
+{
+    EXPECT_EQ(0, toggleAllocations(rankedGroups));
+}
+
+/** @brief Toggling a group which changes the LEDs does not allocate once the
+ *         sets are recycled. Only the LED states are computed, driving the
+ *         physical LEDs goes through D-Bus, which allocates. */
+TEST(AllocationTest, changingToggle)
+{
+    auto bus = sdbusplus::bus::new_default();
+    Manager manager(bus, distinctLedGroups);
+
+    auto handleA = manager.findGroupHandle(groupA);
+    ASSERT_TRUE(handleA);
+
+    ActionSet ledsAssert{};
+    ActionSet ledsDeAssert{};
+    auto toggle = [&](bool assert) {
+        manager.setGroupState(*handleA, assert, ledsAssert, ledsDeAssert);
+        EXPECT_EQ(assert ? 2 : 0, ledsAssert.size());
+        EXPECT_EQ(assert ? 0 : 2, ledsDeAssert.size());
+        manager.recycle(ledsAssert);
+        manager.recycle(ledsDeAssert);
+    };
+
+    // The first toggle creates the nodes
+    toggle(true);
+    toggle(false);
+
+    auto before = allocations.load();
+    for (int i = 0; i < 100; ++i)
+    {
+        toggle((i % 2) == 0);
+    }
+    EXPECT_EQ(0, allocations.load() - before);
+}
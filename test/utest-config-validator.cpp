@@ -30,6 +30,7 @@ TEST(validateConfig, testGoodPathLedPriority)
     GroupMap ledMap = {{"group1", group1}};
 
     validateConfigV1(ledMap);
+    EXPECT_EQ(PriorityMode::led, getPriorityMode(ledMap));
 }
 
 TEST(validateConfig, testGoodPathGroupPriority)
@@ -50,6 +51,7 @@ TEST(validateConfig, testGoodPathGroupPriority)
     };
 
     validateConfigV1(ledMap);
+    EXPECT_EQ(PriorityMode::group, getPriorityMode(ledMap));
 }
 
 TEST(validateConfig, testLedPriorityMismatch)
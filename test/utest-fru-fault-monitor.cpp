@@ -0,0 +1,77 @@
+#include "fru-fault-monitor.hpp"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::led::fru::fault::monitor;
+
+static constexpr auto entry1 = "/xyz/openbmc_project/logging/entry/1";
+static constexpr auto entry2 = "/xyz/openbmc_project/logging/entry/2";
+static constexpr auto fan0 =
+    "/xyz/openbmc_project/inventory/system/chassis/fan0";
+static constexpr auto fan1 =
+    "/xyz/openbmc_project/inventory/system/chassis/fan1";
+
+using Frus = std::vector<std::string>;
+
+/** @brief A FRU is faulted once while entries call it out */
+TEST(CalloutsTest, countEntries)
+{
+    Callouts callouts;
+
+    auto changes = callouts.set(entry1, {fan0, fan0});
+    EXPECT_EQ(Frus{fan0}, changes.faulted);
+    EXPECT_TRUE(changes.cleared.empty());
+
+    changes = callouts.set(entry2, {fan0});
+    EXPECT_TRUE(changes.faulted.empty());
+
+    changes = callouts.remove(entry1);
+    EXPECT_TRUE(changes.cleared.empty());
+    EXPECT_TRUE(callouts.isFaulted(fan0));
+
+    changes = callouts.remove(entry2);
+    EXPECT_EQ(Frus{fan0}, changes.cleared);
+    EXPECT_FALSE(callouts.isFaulted(fan0));
+}
+
+/** @brief Resolving an entry clears its associations and releases its FRUs,
+ *         deleting it afterwards changes nothing */
+TEST(CalloutsTest, resolveEntry)
+{
+    Callouts callouts;
+
+    callouts.set(entry1, {fan0, fan1});
+    callouts.set(entry2, {fan1});
+
+    auto changes = callouts.set(entry1, {});
+    EXPECT_TRUE(changes.faulted.empty());
+    EXPECT_EQ(Frus{fan0}, changes.cleared);
+    EXPECT_FALSE(callouts.isFaulted(fan0));
+    EXPECT_TRUE(callouts.isFaulted(fan1));
+
+    changes = callouts.remove(entry1);
+    EXPECT_TRUE(changes.faulted.empty());
+    EXPECT_TRUE(changes.cleared.empty());
+
+    changes = callouts.set(entry2, {});
+    EXPECT_EQ(Frus{fan1}, changes.cleared);
+    EXPECT_FALSE(callouts.isFaulted(fan1));
+}
+
+/** @brief Changed associations fault and clear only the FRUs which changed */
+TEST(CalloutsTest, replaceCallouts)
+{
+    Callouts callouts;
+
+    callouts.set(entry1, {fan0});
+    auto changes = callouts.set(entry1, {fan1, fan0});
+    EXPECT_EQ(Frus{fan1}, changes.faulted);
+    EXPECT_TRUE(changes.cleared.empty());
+
+    changes = callouts.set(entry1, {fan1});
+    EXPECT_TRUE(changes.faulted.empty());
+    EXPECT_EQ(Frus{fan0}, changes.cleared);
+}
@@ -4,7 +4,13 @@
 #include <sdbusplus/bus.hpp>
 #include <xyz/openbmc_project/Led/Physical/server.hpp>
 
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <random>
 #include <set>
+#include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -374,3 +380,147 @@ TEST_F(LedTest, test_OCP_Panel_Indicator_6_5_BBU_status)
                   {bbu_eol, Layout::Action::Off},
               });
 }
+
+/** @brief Explain an LED driven by the group priorities */
+TEST_F(LedTest, explainGroupPriority)
+{
+    Manager manager(bus, groups2);
+
+    static constexpr auto groupA =
+        "/xyz/openbmc_project/ledmanager/groups/groupA";
+    static constexpr auto groupB =
+        "/xyz/openbmc_project/ledmanager/groups/groupB";
+    static constexpr auto groupC =
+        "/xyz/openbmc_project/ledmanager/groups/groupC";
+
+    ActionSet ledsAssert{};
+    ActionSet ledsDeAssert{};
+    manager.setGroupState(groupA, true, ledsAssert, ledsDeAssert);
+    manager.setGroupState(groupB, true, ledsAssert, ledsDeAssert);
+    manager.setGroupState(groupC, true, ledsAssert, ledsDeAssert);
+
+    // groupB has the highest priority on led3
+    auto explanation = manager.explain("led3");
+    EXPECT_EQ(2, explanation.contributors.size());
+    EXPECT_EQ(groupB, explanation.winner);
+    EXPECT_EQ(Manager::Rule::groupPriority, explanation.rule);
+
+    // groupB turns led2 off over groupA
+    explanation = manager.explain("led2");
+    EXPECT_EQ(2, explanation.contributors.size());
+    EXPECT_EQ(groupB, explanation.winner);
+
+    // No group contains the LED
+    explanation = manager.explain("led5");
+    EXPECT_TRUE(explanation.contributors.empty());
+    EXPECT_TRUE(explanation.winner.empty());
+    EXPECT_EQ(Manager::Rule::none, explanation.rule);
+}
+
+/** @brief Many groups follow the group priorities as getNewMap does */
+TEST_F(LedTest, assertManyGroups)
+{
+    static constexpr size_t groupCount = 200;
+    static constexpr size_t ledCount = 24;
+    static constexpr std::array actions = {
+        Layout::Action::On, Layout::Action::Blink, Layout::Action::Off};
+
+    // More groups than the bits of a word, with unique priorities
+    std::mt19937 random(7);
+    std::vector<int> priorities(groupCount);
+    std::iota(priorities.begin(), priorities.end(), 1);
+    std::ranges::shuffle(priorities, random);
+
+    phosphor::led::GroupMap groups;
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < groupCount; ++i)
+    {
+        ActionSet actionSet;
+        for (size_t j = 0; j < 4; ++j)
+        {
+            actionSet.insert({"led" + std::to_string(random() % ledCount),
+                              actions[random() % actions.size()],
+                              static_cast<uint8_t>(i % 100), 1000,
+                              std::nullopt});
+        }
+        paths.push_back("/xyz/openbmc_project/ledmanager/groups/group" +
+                        std::to_string(i));
+        groups.emplace(paths.back(),
+                       Layout::GroupLayout{priorities[i], actionSet});
+    }
+
+    Manager manager(bus, groups);
+    std::set<const Layout::GroupLayout*> assertedGroups;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        const auto& path = paths[random() % groupCount];
+        bool assert = (random() % 3) != 0;
+
+        ActionSet ledsAssert{};
+        ActionSet ledsDeAssert{};
+        manager.setGroupState(path, assert, ledsAssert, ledsDeAssert);
+        if (assert)
+        {
+            assertedGroups.insert(&groups.at(path));
+        }
+        else
+        {
+            assertedGroups.erase(&groups.at(path));
+        }
+
+        auto expected = Manager::getNewMap(assertedGroups);
+        auto states = manager.getLedStates();
+        ASSERT_EQ(expected.size(), states.size());
+        for (const auto& [name, action] : expected)
+        {
+            ASSERT_TRUE(states.contains(name));
+            EXPECT_EQ(action.action, states.at(name).action);
+            EXPECT_EQ(action.dutyOn, states.at(name).dutyOn);
+        }
+    }
+}
+
+/** @brief An LED in groups whose bits are far apart */
+TEST_F(LedTest, assertDistantGroups)
+{
+    static constexpr size_t groupCount = 1000;
+    static constexpr auto shared = "shared";
+
+    phosphor::led::GroupMap groups;
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < groupCount; ++i)
+    {
+        ActionSet actionSet = {{"led" + std::to_string(i), Layout::Action::On,
+                                0, 0, std::nullopt}};
+        if (i == 0)
+        {
+            actionSet.insert(
+                {shared, Layout::Action::Blink, 50, 1000, std::nullopt});
+        }
+        if (i == groupCount - 1)
+        {
+            actionSet.insert({shared, Layout::Action::On, 0, 0, std::nullopt});
+        }
+        paths.push_back("/xyz/openbmc_project/ledmanager/groups/group" +
+                        std::to_string(i));
+        groups.emplace(paths.back(),
+                       Layout::GroupLayout{static_cast<int>(i) + 1, actionSet});
+    }
+
+    Manager manager(bus, groups);
+    ActionSet ledsAssert{};
+    ActionSet ledsDeAssert{};
+
+    manager.setGroupState(paths.front(), true, ledsAssert, ledsDeAssert);
+    EXPECT_EQ(Layout::Action::Blink, manager.getLedStates().at(shared).action);
+
+    // The last group has the highest priority
+    manager.setGroupState(paths.back(), true, ledsAssert, ledsDeAssert);
+    EXPECT_EQ(Layout::Action::On, manager.getLedStates().at(shared).action);
+
+    manager.setGroupState(paths.back(), false, ledsAssert, ledsDeAssert);
+    EXPECT_EQ(Layout::Action::Blink, manager.getLedStates().at(shared).action);
+
+    manager.setGroupState(paths.front(), false, ledsAssert, ledsDeAssert);
+    EXPECT_FALSE(manager.getLedStates().contains(shared));
+}
@@ -0,0 +1,148 @@
+#include "group-updater.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::led;
+
+static constexpr auto group = "/xyz/openbmc_project/led/groups/enclosure";
+
+/** @brief Run the event loop until the condition holds or the timeout */
+template <typename Condition>
+static bool runUntil(sdeventplus::Event& event, Condition condition,
+                     std::chrono::milliseconds timeout)
+{
+    auto end = std::chrono::steady_clock::now() + timeout;
+    while (!condition() && std::chrono::steady_clock::now() < end)
+    {
+        event.run(std::chrono::milliseconds(10));
+    }
+    return condition();
+}
+
+/** @brief The changes of a frozen group are counted as dampened */
+TEST(GroupUpdaterTest, countDampenedTransitions)
+{
+    auto bus = sdbusplus::bus::new_default();
+    auto event = sdeventplus::Event::get_default();
+
+    std::vector<bool> writes;
+    Dampening damping{std::chrono::milliseconds(0), 2,
+                      std::chrono::hours(1)};
+    GroupUpdater updater(bus, event, std::chrono::milliseconds(50), damping,
+                         [&writes](const std::string&, bool assert) {
+                             writes.push_back(assert);
+                             return true;
+                         });
+
+    // The third change exceeds the limit and freezes the group
+    updater.set(group, true);
+    updater.set(group, false);
+    EXPECT_EQ(0, updater.getDampenedTransitions());
+    updater.set(group, true);
+    EXPECT_EQ(1, updater.getDampenedTransitions());
+
+    // Requesting the same state again is not a change
+    updater.set(group, true);
+    EXPECT_EQ(1, updater.getDampenedTransitions());
+    updater.set(group, false);
+    EXPECT_EQ(2, updater.getDampenedTransitions());
+
+    // Nothing is written before the end of the window
+    EXPECT_TRUE(writes.empty());
+}
+
+/** @brief Nothing is dampened when the dampening is disabled */
+TEST(GroupUpdaterTest, noDampening)
+{
+    auto bus = sdbusplus::bus::new_default();
+    auto event = sdeventplus::Event::get_default();
+
+    GroupUpdater updater(bus, event, std::chrono::milliseconds(50),
+                         Dampening{},
+                         [](const std::string&, bool) { return true; });
+
+    for (int i = 0; i < 10; ++i)
+    {
+        updater.set(group, (i % 2) == 0);
+    }
+    EXPECT_EQ(0, updater.getDampenedTransitions());
+}
+
+/** @brief The latest stable state of a frozen group is written once the
+ *         penalty decays */
+TEST(GroupUpdaterTest, writeFrozenGroupWhenReleased)
+{
+    auto bus = sdbusplus::bus::new_default();
+    auto event = sdeventplus::Event::get_default();
+
+    std::vector<bool> writes;
+    Dampening damping{std::chrono::milliseconds(0), 2,
+                      std::chrono::milliseconds(100)};
+    GroupUpdater updater(bus, event, std::chrono::milliseconds(10), damping,
+                         [&writes](const std::string&, bool assert) {
+                             writes.push_back(assert);
+                             return true;
+                         });
+
+    // Frozen on the third change, the last change asserts the group
+    updater.set(group, true);
+    updater.set(group, false);
+    updater.set(group, true);
+    updater.set(group, false);
+    updater.set(group, true);
+    EXPECT_EQ(3, updater.getDampenedTransitions());
+
+    // Still frozen after the window
+    runUntil(event, [] { return false; }, std::chrono::milliseconds(50));
+    EXPECT_TRUE(writes.empty());
+
+    ASSERT_TRUE(runUntil(event, [&writes] { return !writes.empty(); },
+                         std::chrono::seconds(2)));
+    runUntil(event, [] { return false; }, std::chrono::milliseconds(50));
+    EXPECT_EQ(std::vector<bool>{true}, writes);
+}
+
+/** @brief A deassert within the minimum hold time is written once the hold
+ *         time elapsed */
+TEST(GroupUpdaterTest, writeDeassertAfterMinHold)
+{
+    auto bus = sdbusplus::bus::new_default();
+    auto event = sdeventplus::Event::get_default();
+
+    std::vector<bool> writes;
+    std::chrono::steady_clock::time_point asserted;
+    Dampening damping{std::chrono::milliseconds(100), 0,
+                      std::chrono::milliseconds(0)};
+    GroupUpdater updater(bus, event, std::chrono::milliseconds(10), damping,
+                         [&](const std::string&, bool assert) {
+                             if (assert)
+                             {
+                                 asserted = std::chrono::steady_clock::now();
+                             }
+                             writes.push_back(assert);
+                             return true;
+                         });
+
+    updater.set(group, true);
+    ASSERT_TRUE(runUntil(event, [&writes] { return !writes.empty(); },
+                         std::chrono::seconds(1)));
+
+    // Held while the group was asserted for less than the minimum time
+    updater.set(group, false);
+    EXPECT_EQ(1, updater.getDampenedTransitions());
+    runUntil(event, [] { return false; }, std::chrono::milliseconds(30));
+    EXPECT_EQ(std::vector<bool>{true}, writes);
+
+    ASSERT_TRUE(runUntil(event, [&writes] { return writes.size() == 2; },
+                         std::chrono::seconds(1)));
+    EXPECT_GE(std::chrono::steady_clock::now() - asserted,
+              damping.minHold);
+    EXPECT_EQ((std::vector<bool>{true, false}), writes);
+}
@@ -0,0 +1,118 @@
+#include "manager.hpp"
+#include "snapshot-writer.hpp"
+#include "snapshot.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::led;
+
+static const GroupMap snapshotGroups = {
+    {"/xyz/openbmc_project/ledmanager/groups/groupA",
+     {0,
+      {
+          {"led1", Layout::Action::On, 0, 0, std::nullopt},
+          {"led2", Layout::Action::Blink, 50, 1000, std::nullopt},
+      }}},
+    {"/xyz/openbmc_project/ledmanager/groups/groupB",
+     {0,
+      {
+          {"led3", Layout::Action::On, 0, 0, std::nullopt},
+      }}},
+};
+
+TEST(SnapshotTest, readStates)
+{
+    namespace fs = std::filesystem;
+
+    static constexpr auto path = "config/led-state";
+    static constexpr auto groupA =
+        "/xyz/openbmc_project/ledmanager/groups/groupA";
+
+    auto bus = sdbusplus::bus::new_default();
+    Manager manager(bus, snapshotGroups);
+    manager.setSnapshot(
+        std::make_shared<snapshot::Writer>(path, snapshotGroups));
+
+    snapshot::Reader reader(path);
+    ASSERT_TRUE(reader.valid());
+
+    std::vector<snapshot::Led> leds;
+    std::vector<snapshot::Group> groups;
+    ASSERT_TRUE(reader.read(leds, groups));
+    ASSERT_EQ(3, leds.size());
+    ASSERT_EQ(2, groups.size());
+    EXPECT_TRUE(std::ranges::all_of(leds, [](const auto& led) {
+        return led.state == snapshot::LedState::off;
+    }));
+
+    ActionSet ledsAssert{};
+    ActionSet ledsDeAssert{};
+    manager.setGroupState(groupA, true, ledsAssert, ledsDeAssert);
+
+    ASSERT_TRUE(reader.read(leds, groups));
+    EXPECT_EQ("led1", leds[0].name);
+    EXPECT_EQ(snapshot::LedState::on, leds[0].state);
+    EXPECT_EQ("led2", leds[1].name);
+    EXPECT_EQ(snapshot::LedState::blink, leds[1].state);
+    EXPECT_EQ(50, leds[1].dutyOn);
+    EXPECT_EQ(1000, leds[1].period);
+    EXPECT_EQ(snapshot::LedState::off, leds[2].state);
+
+    EXPECT_EQ(groupA, groups[0].path);
+    EXPECT_TRUE(groups[0].asserted);
+    EXPECT_FALSE(groups[1].asserted);
+
+    fs::remove(path);
+}
+
+/** @brief A reader maps the new snapshot when the manager restarts */
+TEST(SnapshotTest, readAfterRestart)
+{
+    namespace fs = std::filesystem;
+
+    static constexpr auto path = "config/led-state-restart";
+    static constexpr auto groupA =
+        "/xyz/openbmc_project/ledmanager/groups/groupA";
+    static constexpr auto groupB =
+        "/xyz/openbmc_project/ledmanager/groups/groupB";
+
+    auto bus = sdbusplus::bus::new_default();
+    ActionSet ledsAssert{};
+    ActionSet ledsDeAssert{};
+
+    Manager oldManager(bus, snapshotGroups);
+    oldManager.setSnapshot(
+        std::make_shared<snapshot::Writer>(path, snapshotGroups));
+    oldManager.setGroupState(groupA, true, ledsAssert, ledsDeAssert);
+
+    snapshot::Reader reader(path);
+    std::vector<snapshot::Led> leds;
+    std::vector<snapshot::Group> groups;
+    ASSERT_TRUE(reader.read(leds, groups));
+    EXPECT_TRUE(groups[0].asserted);
+    EXPECT_FALSE(groups[1].asserted);
+
+    // The restarted manager replaces the file
+    Manager newManager(bus, snapshotGroups);
+    newManager.setSnapshot(
+        std::make_shared<snapshot::Writer>(path, snapshotGroups));
+    newManager.setGroupState(groupB, true, ledsAssert, ledsDeAssert);
+
+    // The retired file is not written any more
+    oldManager.setGroupState(groupA, false, ledsAssert, ledsDeAssert);
+
+    ASSERT_TRUE(reader.read(leds, groups));
+    EXPECT_FALSE(groups[0].asserted);
+    EXPECT_TRUE(groups[1].asserted);
+    EXPECT_EQ(snapshot::LedState::off, leds[0].state);
+    EXPECT_EQ(snapshot::LedState::on, leds[2].state);
+
+    fs::remove(path);
+}
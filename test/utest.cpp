@@ -4,7 +4,10 @@
 #include <sdbusplus/bus.hpp>
 
 #include <algorithm>
+#include <random>
 #include <set>
+#include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 using namespace phosphor::led;
@@ -1902,3 +1905,273 @@ TEST_F(LedTest,
         EXPECT_EQ(0, ledsAssert.size());
     }
 }
+
+/** @brief Query the LED states and the asserted groups */
+TEST_F(LedTest, queryStatesAndAssertedGroups)
+{
+    Manager manager(bus, twoGroupsWithOneComonLEDOn);
+    EXPECT_TRUE(manager.getLedStates().empty());
+    EXPECT_TRUE(manager.getAssertedGroups().empty());
+
+    static constexpr auto groupA =
+        "/xyz/openbmc_project/ledmanager/groups/MultipleLedsASet";
+    static constexpr auto groupB =
+        "/xyz/openbmc_project/ledmanager/groups/MultipleLedsBSet";
+    {
+        ActionSet ledsAssert{};
+        ActionSet ledsDeAssert{};
+        manager.setGroupState(groupA, true, ledsAssert, ledsDeAssert);
+        manager.setGroupState(groupB, true, ledsAssert, ledsDeAssert);
+
+        auto asserted = manager.getAssertedGroups();
+        std::ranges::sort(asserted);
+        EXPECT_EQ((std::vector<std::string>{groupA, groupB}), asserted);
+
+        const auto& states = manager.getLedStates();
+        EXPECT_EQ(5, states.size());
+        for (const auto& name : {"One", "Two", "Three", "Four", "Six"})
+        {
+            ASSERT_TRUE(states.contains(name));
+            EXPECT_EQ(phosphor::led::Layout::Action::On,
+                      states.at(name).action);
+        }
+    }
+    {
+        ActionSet ledsAssert{};
+        ActionSet ledsDeAssert{};
+        manager.setGroupState(groupA, false, ledsAssert, ledsDeAssert);
+
+        EXPECT_EQ((std::vector<std::string>{groupB}),
+                  manager.getAssertedGroups());
+
+        // The LED shared with Set-B stays on
+        const auto& states = manager.getLedStates();
+        EXPECT_EQ(3, states.size());
+        EXPECT_TRUE(states.contains("Three"));
+        EXPECT_FALSE(states.contains("One"));
+    }
+}
+
+/** @brief Explain an LED driven by the LED priority */
+TEST_F(LedTest, explainLedPriority)
+{
+    Manager manager(bus, twoGroupsWithOneComonLEDOnOneLEDBlinkPriority);
+
+    static constexpr auto groupA =
+        "/xyz/openbmc_project/ledmanager/groups/MultipleLedsASet";
+    static constexpr auto groupB =
+        "/xyz/openbmc_project/ledmanager/groups/MultipleLedsBSet";
+
+    // No group asserted, the LED is off
+    auto explanation = manager.explain("Three");
+    EXPECT_TRUE(explanation.contributors.empty());
+    EXPECT_EQ(Manager::Rule::none, explanation.rule);
+
+    ActionSet ledsAssert{};
+    ActionSet ledsDeAssert{};
+    manager.setGroupState(groupB, true, ledsAssert, ledsDeAssert);
+    manager.setGroupState(groupA, true, ledsAssert, ledsDeAssert);
+
+    // Blink is the priority of the LED, Set-A wins
+    explanation = manager.explain("Three");
+    EXPECT_EQ(2, explanation.contributors.size());
+    EXPECT_EQ(groupA, explanation.winner);
+    EXPECT_EQ(Manager::Rule::ledPriority, explanation.rule);
+
+    // Only Set-B contains the LED
+    explanation = manager.explain("Six");
+    ASSERT_EQ(1, explanation.contributors.size());
+    EXPECT_EQ(groupB, explanation.contributors[0].first);
+    EXPECT_EQ(phosphor::led::Layout::Action::On,
+              explanation.contributors[0].second);
+    EXPECT_EQ(groupB, explanation.winner);
+    EXPECT_EQ(Manager::Rule::none, explanation.rule);
+}
+
+/** @brief Explain an LED blinking at the rate of one of its groups */
+TEST_F(LedTest, explainSameActionDiffPeriod)
+{
+    Manager manager(bus, twoGroupsWithOneComonLEDBlinkDiffPeriod);
+
+    static constexpr auto groupA =
+        "/xyz/openbmc_project/ledmanager/groups/MultipleLedsASet";
+    static constexpr auto groupB =
+        "/xyz/openbmc_project/ledmanager/groups/MultipleLedsBSet";
+
+    ActionSet ledsAssert{};
+    ActionSet ledsDeAssert{};
+    manager.setGroupState(groupA, true, ledsAssert, ledsDeAssert);
+    manager.setGroupState(groupB, true, ledsAssert, ledsDeAssert);
+
+    // Both groups blink the LED, the winner is the group whose period the
+    // LED blinks at
+    const auto& states = manager.getLedStates();
+    ASSERT_TRUE(states.contains("Three"));
+    auto period = states.at("Three").period;
+
+    auto explanation = manager.explain("Three");
+    EXPECT_EQ(2, explanation.contributors.size());
+    EXPECT_EQ(period == 1000 ? groupA : groupB, explanation.winner);
+    EXPECT_EQ(Manager::Rule::ledPriority, explanation.rule);
+}
+
+/** @brief Explain an LED whose groups request the same state */
+TEST_F(LedTest, explainNoConflict)
+{
+    Manager manager(bus, twoGroupsWithOneComonLEDOn);
+
+    static constexpr auto groupA =
+        "/xyz/openbmc_project/ledmanager/groups/MultipleLedsASet";
+    static constexpr auto groupB =
+        "/xyz/openbmc_project/ledmanager/groups/MultipleLedsBSet";
+
+    ActionSet ledsAssert{};
+    ActionSet ledsDeAssert{};
+    manager.setGroupState(groupA, true, ledsAssert, ledsDeAssert);
+    manager.setGroupState(groupB, true, ledsAssert, ledsDeAssert);
+
+    auto explanation = manager.explain("Three");
+    EXPECT_EQ(2, explanation.contributors.size());
+    EXPECT_FALSE(explanation.winner.empty());
+    EXPECT_EQ(Manager::Rule::none, explanation.rule);
+}
+
+/** @brief Assert and deassert groups by handle */
+TEST_F(LedTest, assertByHandle)
+{
+    Manager manager(bus, twoGroupsWithOneComonLEDOn);
+
+    static constexpr auto groupA =
+        "/xyz/openbmc_project/ledmanager/groups/MultipleLedsASet";
+    auto handle = manager.findGroupHandle(groupA);
+    ASSERT_TRUE(handle.has_value());
+    EXPECT_FALSE(manager.findGroupHandle(
+        "/xyz/openbmc_project/ledmanager/groups/Unknown"));
+    {
+        ActionSet ledsAssert{};
+        ActionSet ledsDeAssert{};
+        EXPECT_TRUE(
+            manager.setGroupState(*handle, true, ledsAssert, ledsDeAssert));
+        EXPECT_EQ(3, ledsAssert.size());
+        EXPECT_EQ((std::vector<std::string>{groupA}),
+                  manager.getAssertedGroups());
+    }
+    {
+        // Asserting again changes nothing
+        ActionSet ledsAssert{};
+        ActionSet ledsDeAssert{};
+        manager.setGroupState(*handle, true, ledsAssert, ledsDeAssert);
+        EXPECT_EQ(0, ledsAssert.size());
+        EXPECT_EQ(0, ledsDeAssert.size());
+    }
+    {
+        // The path and the handle refer to the same group
+        ActionSet ledsAssert{};
+        ActionSet ledsDeAssert{};
+        EXPECT_FALSE(
+            manager.setGroupState(groupA, false, ledsAssert, ledsDeAssert));
+        EXPECT_EQ(3, ledsDeAssert.size());
+        EXPECT_TRUE(manager.getAssertedGroups().empty());
+    }
+}
+
+/** @brief Many groups follow the LED priorities as getNewMap does */
+TEST_F(LedTest, assertManyGroups)
+{
+    static constexpr size_t groupCount = 200;
+    static constexpr size_t ledCount = 24;
+
+    // Each LED has a priority action and one other action, more groups than
+    // the bits of a word
+    std::mt19937 random(7);
+    auto getAction = [](size_t led, bool priority) {
+        bool blink = (led % 2) == 0;
+        return (blink == priority) ? Layout::Action::Blink : Layout::Action::On;
+    };
+
+    phosphor::led::GroupMap groups;
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < groupCount; ++i)
+    {
+        ActionSet actionSet;
+        for (size_t j = 0; j < 4; ++j)
+        {
+            auto led = random() % ledCount;
+            actionSet.insert({"led" + std::to_string(led),
+                              getAction(led, (random() % 4) == 0), 50, 1000,
+                              getAction(led, true)});
+        }
+        paths.push_back("/xyz/openbmc_project/ledmanager/groups/group" +
+                        std::to_string(i));
+        groups.emplace(paths.back(), Layout::GroupLayout{0, actionSet});
+    }
+
+    Manager manager(bus, groups);
+    std::set<const Layout::GroupLayout*> assertedGroups;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        const auto& path = paths[random() % groupCount];
+        bool assert = (random() % 3) != 0;
+
+        ActionSet ledsAssert{};
+        ActionSet ledsDeAssert{};
+        manager.setGroupState(path, assert, ledsAssert, ledsDeAssert);
+        if (assert)
+        {
+            assertedGroups.insert(&groups.at(path));
+        }
+        else
+        {
+            assertedGroups.erase(&groups.at(path));
+        }
+
+        auto expected = Manager::getNewMap(assertedGroups);
+        auto states = manager.getLedStates();
+        ASSERT_EQ(expected.size(), states.size());
+        for (const auto& [name, action] : expected)
+        {
+            ASSERT_TRUE(states.contains(name));
+            EXPECT_EQ(action.action, states.at(name).action);
+        }
+    }
+}
+
+/** @brief An LED priority held by a group whose bit is far from the others */
+TEST_F(LedTest, assertDistantGroups)
+{
+    static constexpr size_t groupCount = 1000;
+    static constexpr auto shared = "shared";
+
+    phosphor::led::GroupMap groups;
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < groupCount; ++i)
+    {
+        ActionSet actionSet = {{"led" + std::to_string(i), Layout::Action::On,
+                                0, 0, Layout::Action::On}};
+        if (i == 0)
+        {
+            actionSet.insert(
+                {shared, Layout::Action::On, 0, 0, Layout::Action::Blink});
+        }
+        if (i == groupCount - 1)
+        {
+            actionSet.insert({shared, Layout::Action::Blink, 50, 1000,
+                              Layout::Action::Blink});
+        }
+        paths.push_back("/xyz/openbmc_project/ledmanager/groups/group" +
+                        std::to_string(i));
+        groups.emplace(paths.back(), Layout::GroupLayout{0, actionSet});
+    }
+
+    Manager manager(bus, groups);
+    ActionSet ledsAssert{};
+    ActionSet ledsDeAssert{};
+
+    // Blink is the priority of the LED, whatever the order of the groups
+    manager.setGroupState(paths.back(), true, ledsAssert, ledsDeAssert);
+    manager.setGroupState(paths.front(), true, ledsAssert, ledsDeAssert);
+    EXPECT_EQ(Layout::Action::Blink, manager.getLedStates().at(shared).action);
+
+    manager.setGroupState(paths.back(), false, ledsAssert, ledsDeAssert);
+    EXPECT_EQ(Layout::Action::On, manager.getLedStates().at(shared).action);
+}
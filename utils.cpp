@@ -40,19 +40,73 @@ std::string DBusHandler::getService(const std::string& path,
     return mapperResponse.cbegin()->first;
 }
 
+// Get service name asynchronously
+sdbusplus::slot_t DBusHandler::getServiceAsync(
+    const std::string& path, const std::string& interface,
+    ServiceCallback callback)
+{
+    using InterfaceList = std::vector<std::string>;
+
+    auto& bus = DBusHandler::getBus();
+
+    auto mapper = bus.new_method_call(
+        ObjectMapper::default_service, ObjectMapper::instance_path,
+        ObjectMapper::interface, ObjectMapper::method_names::get_object);
+    mapper.append(path, InterfaceList({interface}));
+
+    return bus.call_async(
+        mapper, [path, interface, callback = std::move(callback)](
+                    sdbusplus::message_t& reply) {
+            std::unordered_map<std::string, std::vector<std::string>>
+                mapperResponse;
+            try
+            {
+                if (!reply.is_method_error())
+                {
+                    reply.read(mapperResponse);
+                }
+            }
+            catch (const sdbusplus::exception_t& e)
+            {
+                lg2::error(
+                    "Failed to parse getService mapper response, ERROR = {ERROR}",
+                    "ERROR", e);
+            }
+
+            if (mapperResponse.empty())
+            {
+                lg2::error(
+                    "Failed to read getService mapper response, OBJECT_PATH = {PATH}, INTERFACE = {INTERFACE}",
+                    "PATH", path, "INTERFACE", interface);
+                return;
+            }
+
+            callback(mapperResponse.cbegin()->first);
+        });
+}
+
 // Get all properties
 PropertyMap DBusHandler::getAllProperties(const std::string& objectPath,
                                           const std::string& interface)
 {
-    PropertyMap properties;
-
-    auto& bus = DBusHandler::getBus();
     auto service = getService(objectPath, interface);
     if (service.empty())
     {
-        return properties;
+        return {};
     }
 
+    return getAllProperties(service, objectPath, interface);
+}
+
+// Get all properties from a known service
+PropertyMap DBusHandler::getAllProperties(const std::string& service,
+                                          const std::string& objectPath,
+                                          const std::string& interface)
+{
+    PropertyMap properties;
+
+    auto& bus = DBusHandler::getBus();
+
     auto method =
         bus.new_method_call(service.c_str(), objectPath.c_str(),
                             "org.freedesktop.DBus.Properties", "GetAll");
@@ -64,6 +118,20 @@ PropertyMap DBusHandler::getAllProperties(const std::string& objectPath,
     return properties;
 }
 
+sdbusplus::slot_t DBusHandler::getAllPropertiesAsync(
+    const std::string& service, const std::string& objectPath,
+    const std::string& interface, AsyncCallback callback)
+{
+    auto& bus = DBusHandler::getBus();
+
+    auto method =
+        bus.new_method_call(service.c_str(), objectPath.c_str(),
+                            "org.freedesktop.DBus.Properties", "GetAll");
+    method.append(interface);
+
+    return bus.call_async(method, std::move(callback));
+}
+
 // Get the property name
 PropertyValue DBusHandler::getProperty(const std::string& objectPath,
                                        const std::string& interface,
@@ -107,6 +175,21 @@ void DBusHandler::setProperty(
     bus.call_noreply(method);
 }
 
+// Set property asynchronously
+sdbusplus::slot_t DBusHandler::setPropertyAsync(
+    const std::string& service, const std::string& objectPath,
+    const std::string& interface, const std::string& propertyName,
+    const PropertyValue& value, AsyncCallback callback)
+{
+    auto& bus = DBusHandler::getBus();
+
+    auto method = bus.new_method_call(service.c_str(), objectPath.c_str(),
+                                      "org.freedesktop.DBus.Properties", "Set");
+    method.append(interface.c_str(), propertyName.c_str(), value);
+
+    return bus.call_async(method, std::move(callback));
+}
+
 std::vector<std::string> DBusHandler::getSubTreePaths(
     const std::string& objectPath, const std::string& interface)
 {
@@ -128,6 +211,48 @@ std::vector<std::string> DBusHandler::getSubTreePaths(
     return paths;
 }
 
+sdbusplus::slot_t DBusHandler::getSubTreeAsync(const std::string& objectPath,
+                                               const std::string& interface,
+                                               SubTreeCallback callback)
+{
+    auto& bus = DBusHandler::getBus();
+
+    auto method = bus.new_method_call(
+        ObjectMapper::default_service, ObjectMapper::instance_path,
+        ObjectMapper::interface, ObjectMapper::method_names::get_sub_tree);
+    method.append(objectPath.c_str());
+    method.append(0); // Depth 0 to search all
+    method.append(std::vector<std::string>({interface}));
+
+    return bus.call_async(
+        method, [objectPath, interface, callback = std::move(callback)](
+                    sdbusplus::message_t& reply) {
+            SubTree subTree;
+            try
+            {
+                if (reply.is_method_error())
+                {
+                    lg2::error(
+                        "Failed to call the SubTree method, PATH = {PATH}, INTERFACE = {INTERFACE}",
+                        "PATH", objectPath, "INTERFACE", interface);
+                }
+                else
+                {
+                    reply.read(subTree);
+                }
+            }
+            catch (const sdbusplus::exception_t& e)
+            {
+                lg2::error(
+                    "Failed to parse SubTree response, ERROR = {ERROR}, PATH = {PATH}",
+                    "ERROR", e, "PATH", objectPath);
+                subTree.clear();
+            }
+
+            callback(subTree);
+        });
+}
+
 } // namespace utils
 } // namespace led
 } // namespace phosphor
@@ -1,6 +1,7 @@
 #pragma once
 #include <sdbusplus/server.hpp>
 
+#include <functional>
 #include <unordered_map>
 #include <vector>
 namespace phosphor
@@ -22,6 +23,19 @@ using DbusProperty = std::string;
 // The Map to constructs all properties values of the interface
 using PropertyMap = std::unordered_map<DbusProperty, PropertyValue>;
 
+// The mapper GetSubTree response, object path -> service -> interfaces
+using SubTree = std::unordered_map<
+    std::string, std::unordered_map<std::string, std::vector<std::string>>>;
+
+// Callback invoked with the reply (or error) of an asynchronous call
+using AsyncCallback = std::function<void(sdbusplus::message_t&)>;
+
+// Callback invoked with the service name found by an asynchronous lookup
+using ServiceCallback = std::function<void(const std::string&)>;
+
+// Callback invoked with the sub tree found by an asynchronous lookup
+using SubTreeCallback = std::function<void(const SubTree&)>;
+
 /**
  *  @class DBusHandler
  *
@@ -51,6 +65,23 @@ class DBusHandler
     static std::string getService(const std::string& path,
                                   const std::string& interface);
 
+    /**
+     *  @brief Get service name by the path and interface of the DBus without
+     *         waiting for the mapper reply.
+     *
+     *  @param[in] path      -  D-Bus object path
+     *  @param[in] interface -  D-Bus Interface
+     *  @param[in] callback  -  Invoked with the D-Bus service name, only when
+     *                          the lookup succeeds
+     *
+     *  @return The slot of the pending call, dropping it cancels the call
+     *
+     *  @throw sdbusplus::exception_t when the call cannot be sent
+     */
+    static sdbusplus::slot_t getServiceAsync(const std::string& path,
+                                             const std::string& interface,
+                                             ServiceCallback callback);
+
     /** @brief Get All properties
      *
      *  @param[in] objectPath       -   D-Bus object path
@@ -63,6 +94,36 @@ class DBusHandler
     static PropertyMap getAllProperties(const std::string& objectPath,
                                         const std::string& interface);
 
+    /** @brief Get All properties from a known service
+     *
+     *  @param[in] service          -   D-Bus service name
+     *  @param[in] objectPath       -   D-Bus object path
+     *  @param[in] interface        -   D-Bus interface
+     *
+     *  @return The Map to constructs all properties values
+     *
+     *  @throw sdbusplus::exception_t when it fails
+     */
+    static PropertyMap getAllProperties(const std::string& service,
+                                        const std::string& objectPath,
+                                        const std::string& interface);
+
+    /** @brief Get All properties from a known service without waiting for
+     *         the reply
+     *
+     *  @param[in] service          -   D-Bus service name
+     *  @param[in] objectPath       -   D-Bus object path
+     *  @param[in] interface        -   D-Bus interface
+     *  @param[in] callback         -   Invoked with the reply message
+     *
+     *  @return The slot of the pending call, dropping it cancels the call
+     *
+     *  @throw sdbusplus::exception_t when the call cannot be sent
+     */
+    static sdbusplus::slot_t getAllPropertiesAsync(
+        const std::string& service, const std::string& objectPath,
+        const std::string& interface, AsyncCallback callback);
+
     /** @brief Get property(type: variant)
      *
      *  @param[in] objectPath       -   D-Bus object path
@@ -91,6 +152,25 @@ class DBusHandler
                             const std::string& propertyName,
                             const PropertyValue& value);
 
+    /** @brief Set D-Bus property on a known service without waiting for the
+     *         reply
+     *
+     *  @param[in] service          -   D-Bus service name
+     *  @param[in] objectPath       -   D-Bus object path
+     *  @param[in] interface        -   D-Bus interface
+     *  @param[in] propertyName     -   D-Bus property name
+     *  @param[in] value            -   The value to be set
+     *  @param[in] callback         -   Invoked with the reply message
+     *
+     *  @return The slot of the pending call, dropping it cancels the call
+     *
+     *  @throw sdbusplus::exception_t when the call cannot be sent
+     */
+    static sdbusplus::slot_t setPropertyAsync(
+        const std::string& service, const std::string& objectPath,
+        const std::string& interface, const std::string& propertyName,
+        const PropertyValue& value, AsyncCallback callback);
+
     /** @brief Get sub tree paths by the path and interface of the DBus.
      *
      *  @param[in]  objectPath   -  D-Bus object path
@@ -100,6 +180,22 @@ class DBusHandler
      */
     static std::vector<std::string> getSubTreePaths(
         const std::string& objectPath, const std::string& interface);
+
+    /** @brief Get sub tree with services by the path and interface of the
+     *         DBus without waiting for the mapper reply.
+     *
+     *  @param[in]  objectPath   -  D-Bus object path
+     *  @param[in]  interface    -  D-Bus object interface
+     *  @param[in]  callback     -  Invoked with the sub tree, empty when the
+     *                              lookup fails
+     *
+     *  @return The slot of the pending call, dropping it cancels the call
+     *
+     *  @throw sdbusplus::exception_t when the call cannot be sent
+     */
+    static sdbusplus::slot_t getSubTreeAsync(const std::string& objectPath,
+                                             const std::string& interface,
+                                             SubTreeCallback callback);
 };
 
 } // namespace utils